@@ -1,6 +1,8 @@
 #include "util.h"
 
 #include "bs.h"
+#include "distributed.h"
+#include "parallel.h"
 //#include "BranchAndBound.h"
 #include "InputParser.h"
 #include "glpk.h"
@@ -9,6 +11,8 @@
 #include <algorithm>
 #include <iostream>
 #include <string>
+// getpid
+#include <unistd.h>
 
 int main(int argc, char **argv) {
   InputParser input(argc, argv);
@@ -24,18 +28,82 @@ int main(int argc, char **argv) {
               << "  -d/--debug\n"
               << "  -so/--solver-output\n\n"
               << "Algorithm strategy options:\n"
-              << "  -vs [{0|1|2}]\n"
+              << "  -vs [{0|1|2|3|4|5}]\n"
               << "    0. vars are picked on order\n"
               << "    1. vars are picked on fractional part closeness to 0.5\n"
               << "    2. vars are picked on greatest impact on obj. function\n"
-              << "  -bs [{0|1}]\n"
-              << "    0. nodes are picked for DFS (FIFO/queue)\n"
+              << "    3. vars are picked on best pseudocost score\n"
+              << "    4. vars are picked by strong branching\n"
+              << "    --sb-iters [N]\n"
+              << "      Simplex iteration limit of each strong branching probe\n"
+              << "    5. vars are picked by reliability branching\n"
+              << "    --rel-k [K]\n"
+              << "      Pseudocost observations needed to skip probing\n"
+              << "    --rel-lookahead [N]\n"
+              << "      Stop probing after N candidates without improvement\n"
+              << "  -bs [{0|1|2}]\n"
+              << "    0. nodes are picked for DFS (LIFO/stack)\n"
               << "    1. nodes are picked for best-FS (greatest z-value)\n"
+              << "    2. nodes are picked on best estimate, with plunging\n"
+              << "    --plunge-tol [TOL]\n"
+              << "      Dive while a child's bound is within TOL (relative) of "
+                 "the best bound\n"
+              << "    --bound-freq [K]\n"
+              << "      Pick every K-th node by best bound instead of estimate "
+                 "(default 10,\n      0 never does)\n"
+              << "  --restart-frac [0...1]\n"
+              << "    Restart the root on a reduced model once this fraction "
+                 "of the integer\n    columns is fixed (default 0.2, 0 "
+                 "disables)\n"
+              << "  --max-restarts [N]\n"
+              << "    Restart at most N times (default 3)\n"
+              << "  --async-children\n"
+              << "    Solve the two children of every branching on separate "
+                 "threads\n"
+              << "  --concurrent-root\n"
+              << "    Race primal simplex, dual simplex and interior point on "
+                 "the root LP\n"
+              << "  --node-mem [MB]\n"
+              << "    Spill the worst open nodes to disk beyond this much "
+                 "memory\n"
+              << "    --spill-file [PATH] (default /tmp/mvolps-PID-N.spill)\n"
               << "  -cm [{0|1}]\n"
               << "    0. disable cut generation\n"
               << "    1. generate Gomory mixed integer\n"
               << "    -cf [0...1]\n"
-              << "      Percentage of generated cuts to be added per node"
+              << "      Percentage of generated cuts to be added per node\n"
+              << "Tolerance options:\n"
+              << "  --int-tol [TOL] integrality tolerance (default 1e-6)\n"
+              << "  --feas-tol [TOL] primal feasibility tolerance (default "
+                 "1e-7)\n"
+              << "Termination options:\n"
+              << "  --mip-gap [GAP] stop at this relative optimality gap\n"
+              << "  --abs-gap [GAP] stop at this absolute optimality gap\n"
+              << "  --time-limit [SECONDS] stop after this much search time\n"
+              << "  --node-limit [N] stop after N nodes (default 200000, 0 "
+                 "for none)\n"
+              << "  --mem-limit [MB] stop once the process uses this much "
+                 "memory\n\n"
+              << "Parallel options:\n"
+              << "  --threads [N] search with N work-stealing threads\n"
+              << "  --deterministic synchronize the threads in rounds of "
+                 "--subtree-nodes nodes,\n"
+              << "    giving the same search on every run (with no time "
+                 "limit, the memory\n      limit and --concurrent-root are "
+                 "ignored)\n"
+              << "  --race race N differently configured searches, N set by "
+                 "--threads\n"
+              << "  --manager [ENDPOINT] serve nodes to worker processes over "
+                 "ZeroMQ\n"
+              << "    (default ipc:///tmp/mvolps-PID.ipc)\n"
+              << "    --workers [N] fork N local workers (default 0)\n"
+              << "    --worker-timeout [SECONDS] hand the node of a silent "
+                 "worker to another\n      one after this long (default "
+                 "600)\n"
+              << "  --worker [ENDPOINT] search subtrees for a manager, with "
+                 "the same -f\n"
+              << "  --subtree-nodes [N] nodes a worker searches per subtree "
+                 "(default 200)\n\n"
               << "Help:\n"
               << "  -h/--help\n";
 
@@ -95,12 +163,28 @@ int main(int argc, char **argv) {
 
       if (opt == MVOLP::param::NodeStratType::BEST) {
         params.setNodeStrat(MVOLP::param::NodeStratType::BEST);
+      } else if (opt == MVOLP::param::NodeStratType::BE) {
+        params.setNodeStrat(MVOLP::param::NodeStratType::BE);
       } else if (opt == MVOLP::param::NodeStratType::DFS) {
         params.setNodeStrat(MVOLP::param::NodeStratType::DFS);
       } else {
         spdlog::error("Unknown parameter value for -bs");
         return -1;
       }
+
+      if (input.CMDOptionExists("--plunge-tol")) {
+        std::string option = input.getCMDOption("--plunge-tol");
+        params.setPlungeTol(std::stod(option));
+      }
+      if (input.CMDOptionExists("--bound-freq")) {
+        std::string option = input.getCMDOption("--bound-freq");
+        int freq = std::stoi(option);
+        if (freq < 0) {
+          spdlog::error("Bound pick frequency must be non-negative");
+          return -1;
+        }
+        params.setBoundPickFreq(freq);
+      }
     }
 
     if (input.CMDOptionExists("-vs")) {
@@ -111,12 +195,84 @@ int main(int argc, char **argv) {
         params.setVarStrat(MVOLP::param::VarStratType::VFP);
       } else if (opt == MVOLP::param::VarStratType::VGO) {
         params.setVarStrat(MVOLP::param::VarStratType::VGO);
+      } else if (opt == MVOLP::param::VarStratType::PC) {
+        params.setVarStrat(MVOLP::param::VarStratType::PC);
+      } else if (opt == MVOLP::param::VarStratType::SB) {
+        params.setVarStrat(MVOLP::param::VarStratType::SB);
+      } else if (opt == MVOLP::param::VarStratType::REL) {
+        params.setVarStrat(MVOLP::param::VarStratType::REL);
       } else if (opt == MVOLP::param::VarStratType::VO) {
         params.setVarStrat(MVOLP::param::VarStratType::VO);
       } else {
         spdlog::error("Unknown parameter value for -vs");
         return -1;
       }
+
+      if (input.CMDOptionExists("--sb-iters")) {
+        std::string option = input.getCMDOption("--sb-iters");
+        int limit = std::stoi(option);
+        if (limit < 1) {
+          spdlog::error("Strong branching iteration limit must be positive");
+          return -1;
+        }
+
+        params.setStrongIterLimit(limit);
+      }
+
+      if (input.CMDOptionExists("--rel-k")) {
+        std::string option = input.getCMDOption("--rel-k");
+        params.setReliability(std::stoi(option));
+      }
+
+      if (input.CMDOptionExists("--rel-lookahead")) {
+        std::string option = input.getCMDOption("--rel-lookahead");
+        params.setLookahead(std::stoi(option));
+      }
+    }
+
+    if (input.CMDOptionExists("--node-mem")) {
+      std::string option = input.getCMDOption("--node-mem");
+      double megabytes = std::stod(option);
+      if (megabytes < 0.0) {
+        spdlog::error("Node memory budget must be non-negative");
+        return -1;
+      }
+
+      std::string path = "";
+      if (input.CMDOptionExists("--spill-file")) {
+        path = input.getCMDOption("--spill-file");
+      }
+      params.setNodeMem(megabytes, path);
+    }
+
+    if (input.CMDOptionExists("--async-children")) {
+      params.setAsyncChildren(true);
+    }
+
+    if (input.CMDOptionExists("--concurrent-root")) {
+      params.setConcurrentRoot(true);
+    }
+
+    if (input.CMDOptionExists("--restart-frac")) {
+      std::string option = input.getCMDOption("--restart-frac");
+      double frac = std::stod(option);
+      if (!((frac <= 1.0) && (frac >= 0.0))) {
+        spdlog::error("Restart fraction must be in range [0.0, 1.0]");
+        return -1;
+      }
+
+      params.setRestartFrac(frac);
+    }
+
+    if (input.CMDOptionExists("--max-restarts")) {
+      std::string option = input.getCMDOption("--max-restarts");
+      int restarts = std::stoi(option);
+      if (restarts < 0) {
+        spdlog::error("Maximum number of restarts must be non-negative");
+        return -1;
+      }
+
+      params.setMaxRestarts(restarts);
     }
 
     if (input.CMDOptionExists("-cm")) {
@@ -148,7 +304,121 @@ int main(int argc, char **argv) {
       params.setCutStrat(MVOLP::param::CutStratType::NONE);
     }
 
-    branchAndBound(prob, params);
+    if (input.CMDOptionExists("--int-tol")) {
+      std::string option = input.getCMDOption("--int-tol");
+      double tol = std::stod(option);
+      if (!((tol < 0.5) && (tol >= 0.0))) {
+        spdlog::error("Integrality tolerance must be in range [0.0, 0.5)");
+        return -1;
+      }
+
+      params.setIntTol(tol);
+    }
+
+    if (input.CMDOptionExists("--feas-tol")) {
+      std::string option = input.getCMDOption("--feas-tol");
+      double tol = std::stod(option);
+      if (tol <= 0.0) {
+        spdlog::error("Feasibility tolerance must be positive");
+        return -1;
+      }
+
+      params.setFeasTol(tol);
+    }
+
+    if (input.CMDOptionExists("--mip-gap")) {
+      std::string option = input.getCMDOption("--mip-gap");
+      double gap = std::stod(option);
+      if (gap < 0.0) {
+        spdlog::error("Optimality gap must be non-negative");
+        return -1;
+      }
+
+      params.setMipGap(gap);
+    }
+
+    if (input.CMDOptionExists("--abs-gap")) {
+      std::string option = input.getCMDOption("--abs-gap");
+      double gap = std::stod(option);
+      if (gap < 0.0) {
+        spdlog::error("Optimality gap must be non-negative");
+        return -1;
+      }
+
+      params.setAbsGap(gap);
+    }
+
+    if (input.CMDOptionExists("--time-limit")) {
+      std::string option = input.getCMDOption("--time-limit");
+      params.setTimeLimit(std::stod(option));
+    }
+
+    if (input.CMDOptionExists("--node-limit")) {
+      std::string option = input.getCMDOption("--node-limit");
+      params.setNodeLimit(std::stol(option));
+    }
+
+    if (input.CMDOptionExists("--mem-limit")) {
+      std::string option = input.getCMDOption("--mem-limit");
+      params.setMemLimit(std::stod(option));
+    }
+
+    int threads = 1;
+    if (input.CMDOptionExists("--threads")) {
+      std::string option = input.getCMDOption("--threads");
+      threads = std::stoi(option);
+      if (threads < 1) {
+        spdlog::error("Thread count must be at least 1");
+        return -1;
+      }
+    }
+
+    long budget = 200;
+    if (input.CMDOptionExists("--subtree-nodes")) {
+      std::string option = input.getCMDOption("--subtree-nodes");
+      budget = std::stol(option);
+      if (budget < 1) {
+        spdlog::error("Subtree node budget must be at least 1");
+        return -1;
+      }
+    }
+
+    if (input.CMDOptionExists("--manager")) {
+      std::string endpoint = input.getCMDOption("--manager");
+      if (endpoint.empty() || endpoint[0] == '-') {
+        endpoint = sstr("ipc:///tmp/mvolps-", getpid(), ".ipc");
+      }
+      int workers = 0;
+      if (input.CMDOptionExists("--workers")) {
+        workers = std::stoi(input.getCMDOption("--workers"));
+      }
+      double timeout = 600;
+      if (input.CMDOptionExists("--worker-timeout")) {
+        timeout = std::stod(input.getCMDOption("--worker-timeout"));
+        if (timeout <= 0) {
+          spdlog::error("Worker timeout must be positive");
+          return -1;
+        }
+      }
+
+      managerBranchAndBound(prob, params, endpoint, workers, budget, timeout);
+    } else if (input.CMDOptionExists("--worker")) {
+      std::string endpoint = input.getCMDOption("--worker");
+      if (endpoint.empty()) {
+        spdlog::error("--worker needs the manager's endpoint");
+        return -1;
+      }
+
+      workerBranchAndBound(prob, params, endpoint, budget);
+    } else if (input.CMDOptionExists("--deterministic")) {
+      deterministicBranchAndBound(prob, params, threads, budget);
+    } else if (input.CMDOptionExists("--race")) {
+      raceBranchAndBound(prob, params, std::max(threads, 2));
+    } else if (threads > 1) {
+      parallelBranchAndBound(prob, params, threads);
+    } else {
+      branchAndBound(prob, params);
+    }
   } else {
     std::cout << "see ./MVOLPS -h for usage\n";
   }
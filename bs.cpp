@@ -1,7 +1,13 @@
 #include "bs.h"
+#include "conflict.h"
 #include "cut.h"
 #include "gmi.h"
 #include "message.h"
+#include "nodeproc.h"
+#include "nodequeue.h"
+#include "parallel.h"
+#include "redcost.h"
+#include "reduced.h"
 #include "tree.hh"
 #include "tree_print.h"
 #include "tree_util.hh"
@@ -21,11 +27,13 @@
 /*
  * Calling the tree<T> parent function at the root node causes a segfault in
  * the library itself.  To get around that we create a wrapper that
- * (erroneously) says that the root of the tree has root 0
+ * (erroneously) says that the root of the tree has root 0.  The root is found
+ * by its missing parent rather than by its oid, which is only 1 for the first
+ * search of a process
  */
 int getParentOid(const tree<MVOLP::SPInfo> &probs,
                  const tree<MVOLP::SPInfo>::iterator &iter) {
-  if (iter->oid == 1) {
+  if (iter.node->parent == 0) {
     return 0;
   }
 
@@ -36,33 +44,42 @@ int getParentOid(const tree<MVOLP::SPInfo> &probs,
  * in grUMPy there is an arbitrary convention for the BNB tree to branch in the
  * middle direction if its the initial subproblem, to the right for an added
  * upper-bound constraint, and left for an added lower-bound constraint.
- * Unfortunately this is not so easily determined, and to avoid refactoring we
- * must rely on the order in which sub-problems are created (see the end of
- * branchAndBound) which corresponds to an even oid (R), and an odd oid (L)
+ * Children are appended in the order they are created (see the end of
+ * branchAndBound), so the upper-bound child is the first one (R) and the
+ * lower-bound child its next sibling (L).  Oids can not tell, since
+ * concurrent searches draw them from the same counter
  */
-MVOLP::BranchDirection getBranchDirection(const int &oid) {
-  if (oid <= 1) {
+MVOLP::BranchDirection
+getBranchDirection(const tree<MVOLP::SPInfo>::iterator &iter) {
+  if (iter.node->parent == 0) {
     return MVOLP::BranchDirection::M;
   }
-  if (oid % 2 == 0) {
+  if (iter.node->prev_sibling == 0) {
     return MVOLP::BranchDirection::R;
   } else {
     return MVOLP::BranchDirection::L;
   }
 }
 
-int branchAndBound(glp_prob *prob, MVOLP::ParameterObj &params) {
-  MVOLP::BaseMessageDispatch::define<MVOLP::LogDispatch>("LogDispatch");
+int branchAndBound(glp_prob *prob, MVOLP::ParameterObj &params,
+                   MVOLP::RaceContext *race) {
+  // The dispatch factory rejects a second definition of a name, and several
+  // searches may start at once when racing
+  static std::once_flag defined;
+  std::call_once(defined, []() {
+    MVOLP::BaseMessageDispatch::define<MVOLP::LogDispatch>("LogDispatch");
+    MVOLP::BaseMessageDispatch::define<MVOLP::DebugDispatch>("DebugDispatch");
+    MVOLP::BaseMessageDispatch::define<MVOLP::IPCDispatch>("IPCDispatch");
+  });
+
   std::shared_ptr<MVOLP::LogDispatch> logInfo =
       std::dynamic_pointer_cast<MVOLP::LogDispatch>(
           MVOLP::BaseMessageDispatch::create("LogDispatch"));
 
-  MVOLP::BaseMessageDispatch::define<MVOLP::DebugDispatch>("DebugDispatch");
   std::shared_ptr<MVOLP::DebugDispatch> logDebug =
       std::dynamic_pointer_cast<MVOLP::DebugDispatch>(
           MVOLP::BaseMessageDispatch::create("DebugDispatch"));
 
-  MVOLP::BaseMessageDispatch::define<MVOLP::IPCDispatch>("IPCDispatch");
   std::shared_ptr<MVOLP::IPCDispatch> mqDispatch =
       std::dynamic_pointer_cast<MVOLP::IPCDispatch>(
           MVOLP::BaseMessageDispatch::create("IPCDispatch"));
@@ -70,94 +87,239 @@ int branchAndBound(glp_prob *prob, MVOLP::ParameterObj &params) {
     mqDispatch->createServer(params.getServerPort());
   }
 
+  // Integral objectives let node bounds be rounded down before pruning
+  double step = objectiveStep(prob);
+  params.setObjStep(step, glp_get_obj_coef(prob, 0));
+  if (step > 0) {
+    logInfo->message(sstr("Objective takes multiples of ", step))->write();
+  }
+
   CutPool pool;
   tree<MVOLP::SPInfo> subProblems;
   // tree<int> subProblems;
   // maps OID to iterator of that node
   std::map<int, tree<MVOLP::SPInfo>::iterator> treeIndex;
 
-  std::deque<std::shared_ptr<MVOLP::NodeData>> leafContainer;
+  std::unique_ptr<MVOLP::NodeQueue> leafContainer = params.createNodeQueue();
   std::shared_ptr<MVOLP::NodeData> S1 = std::make_shared<MVOLP::NodeData>(prob);
   S1->inital = true;
-  leafContainer.push_back(S1);
+  leafContainer->push(S1);
 
   MVOLP::SPInfo in = {S1->oid, MVOLP::NONE};
   tree<MVOLP::SPInfo>::iterator root =
       subProblems.insert(subProblems.begin(), in);
   treeIndex[S1->oid] = subProblems.begin();
 
-  glp_prob *a = glp_create_prob();
   double bestLower = -std::numeric_limits<double>::infinity();
   double bestUpper = std::numeric_limits<double>::infinity();
 
   std::string solution = "";
   int count = 0;
+  auto searchStart = std::chrono::high_resolution_clock::now();
+
+  // Solves, propagates and branches the nodes.  Its LP workspace a holds the
+  // node being processed
+  MVOLP::NodeProcessor processor(prob, params);
+  glp_prob *a = processor.lp();
+
+  // Reduced costs of the root LP.  Whatever they fix for a given incumbent
+  // holds for the whole tree, so they are applied to prob itself
+  MVOLP::ReducedCosts rootCosts;
+  bool rootCostsSaved = false;
+  int rootFixings = 0;
+
+  // Set once the root has been restarted on a model without its fixed
+  // columns.  prob then points at the reduced model
+  std::unique_ptr<MVOLP::ReducedModel> reduced;
+  int restarts = 0;
+  auto format = [&](glp_prob *lp) {
+    return reduced ? reduced->formatSolution(lp) : formatSolution(lp);
+  };
+
+  // Conflicts learned from infeasible nodes prune matching nodes anywhere in
+  // the tree
+  MVOLP::ConflictPool conflicts(params.getFeasTol());
+  processor.setConflicts(&conflicts);
+
+  // Marks open nodes dropped for good (by a better incumbent) in the tree
+  // and the visualization
+  auto markPruned =
+      [&](const std::vector<std::shared_ptr<MVOLP::NodeData>> &dropped) {
+    for (auto &i : dropped) {
+      tree<MVOLP::SPInfo>::iterator iter = treeIndex[i->oid];
+      MVOLP::BaseMessagePOD pruneMsg;
+      pruneMsg.oid = i->oid;
+      pruneMsg.pid = getParentOid(subProblems, iter);
+      pruneMsg.direction = getBranchDirection(iter);
+
+      mqDispatch->clearAll();
+      if (i->isInfeasible()) {
+        iter.node->data.prune = MVOLP::FEAS;
+        pruneMsg.nodeType = MVOLP::EventType::infeasible;
+        mqDispatch->field9 = 1;
+        mqDispatch->field10 = 2;
+      } else {
+        iter.node->data.prune = MVOLP::BNDS;
+        pruneMsg.nodeType = MVOLP::EventType::fathomed;
+      }
+      mqDispatch->baseFields = pruneMsg;
+      mqDispatch->write();
+    }
+  };
+
+  // Integer columns of prob, and how many of them are fixed once bounds are
+  // applied
+  auto countFixed = [&](const std::vector<MVOLP::BoundChange> &bounds,
+                        int &integers) {
+    int cols = glp_get_num_cols(prob);
+    std::vector<double> lb(cols + 1), ub(cols + 1);
+    for (int j = 1; j <= cols; j++) {
+      getColBnds(prob, j, lb[j], ub[j]);
+    }
+    for (auto &i : bounds) {
+      lb[i.col] = std::max(lb[i.col], i.lb);
+      ub[i.col] = std::min(ub[i.col], i.ub);
+    }
+
+    integers = 0;
+    int fixed = 0;
+    for (int j = 1; j <= cols; j++) {
+      if (glp_get_col_kind(prob, j) != GLP_CV) {
+        integers++;
+        fixed += lb[j] == ub[j];
+      }
+    }
+
+    return fixed;
+  };
+  auto restartDue = [&](int fixed, int integers) {
+    return params.getRestartFrac() > 0 && restarts < params.getMaxRestarts() &&
+           fixed > 0 && fixed >= params.getRestartFrac() * integers;
+  };
+
+  // Starts the search over from a new root, placed below under, on a model
+  // without the columns that bounds and prob fix.  The open nodes are dropped
+  // and everything indexed by column is rebuilt.  Returns the number of
+  // columns removed
+  auto restartSearch = [&](const std::vector<MVOLP::BoundChange> &bounds,
+                           tree<MVOLP::SPInfo>::iterator under) {
+    if (!reduced) {
+      reduced = std::make_unique<MVOLP::ReducedModel>(prob);
+    }
+    for (auto &i : bounds) {
+      tightenColBnds(reduced->prob(), i.col, i.lb, i.ub);
+    }
+    int removed = reduced->removeFixed();
+    prob = reduced->prob();
+    restarts++;
+
+    processor.reset(prob);
+    conflicts = MVOLP::ConflictPool(params.getFeasTol());
+    rootCostsSaved = false;
+    params.resetPseudoCosts();
+    leafContainer = params.createNodeQueue();
+
+    S1 = std::make_shared<MVOLP::NodeData>(prob);
+    S1->inital = true;
+    leafContainer->push(S1);
+    MVOLP::SPInfo sp = {S1->oid, MVOLP::NONE};
+    treeIndex[S1->oid] = subProblems.append_child(under, sp);
+
+    return removed;
+  };
+
+  // Set when the search ends before proving optimality
+  bool stopped = false;
+
+  while (!leafContainer->empty()) {
+    // A racing search adopts the incumbents found by the others, and gives up
+    // as soon as one of them has finished
+    if (race) {
+      if (race->stop) {
+        stopped = true;
+        logInfo->message("Another search finished first.  Stopping")->write();
+        break;
+      }
+
+      double shared = race->incumbent.value();
+      if (shared > bestLower) {
+        bestLower = shared;
+        markPruned(leafContainer->pruneBelow(params.cutoffBound(bestLower)));
+      }
+    }
+
+    // Global dual bound over the open nodes, including the one picked next
+    bestUpper = params.roundBound(leafContainer->bestBound());
+    if (params.gapReached(bestLower, bestUpper)) {
+      logInfo
+          ->message(sstr("Optimality gap ", relativeGap(bestLower, bestUpper),
+                         " (", bestUpper - bestLower,
+                         " absolute) within tolerance.  Stopping with ",
+                         leafContainer->size(), " open nodes"))
+          ->write();
+      break;
+    }
+
+    std::string reason;
+    auto elapsed = std::chrono::high_resolution_clock::now() - searchStart;
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    if (params.limitReached(count, seconds, reason)) {
+      logInfo
+          ->message(sstr("Reached the ", reason, ".  Stopping with ",
+                         leafContainer->size(), " open nodes"))
+          ->write();
+      stopped = true;
+      break;
+    }
 
-  while (!leafContainer.empty()) {
     mqDispatch->clearAll();
-    int index;
     MVOLP::BaseMessagePOD baseMsg;
 
-    std::shared_ptr<MVOLP::NodeData> node =
-        params.pickNode(leafContainer, index);
+    std::shared_ptr<MVOLP::NodeData> node = params.pickNode(*leafContainer);
     root = treeIndex[node->oid];
 
     baseMsg.oid = node->oid;
     baseMsg.pid = getParentOid(subProblems, treeIndex[baseMsg.oid]);
-    baseMsg.direction = getBranchDirection(baseMsg.oid);
+    baseMsg.direction = getBranchDirection(treeIndex[baseMsg.oid]);
 
     logDebug
         ->message(sstr("Current OID: ", node->oid, " with z-value ",
                        node->upperBound))
         ->write();
-    logDebug->message(sstr("Container size: ", leafContainer.size()))->write();
-    glp_erase_prob(a);
-    a = glp_create_prob();
-    glp_copy_prob(a, node->prob, GLP_OFF);
-    glp_simplex(a, NULL);
+    logDebug->message(sstr("Container size: ", leafContainer->size()))
+        ->write();
+
+    MVOLP::NodeResult result = processor.evaluate(*node, bestLower);
+    double objVal = result.objVal;
+    if (!processor.rootWinner().empty()) {
+      logInfo
+          ->message(sstr("OID: ", node->oid, ".  Root LP solved first by ",
+                         processor.rootWinner()))
+          ->write();
+    }
 
     MVOLP::BaseMessagePOD pregenantData;
     pregenantData.nodeType = MVOLP::EventType::pregnant;
     pregenantData.oid = node->oid;
     pregenantData.pid = getParentOid(subProblems, treeIndex[node->oid]);
-    pregenantData.direction = getBranchDirection(node->oid);
+    pregenantData.direction = getBranchDirection(treeIndex[node->oid]);
     mqDispatch->baseFields = pregenantData;
-    mqDispatch->field6 = glp_get_obj_val(a);
+    mqDispatch->field6 = std::isfinite(objVal) ? objVal : 0.0;
     mqDispatch->field9 = 1;
     mqDispatch->field10 = 2;
     mqDispatch->write();
     mqDispatch->clearAll();
 
-    std::pair<int, std::vector<int>> ret;
-    std::vector<int> vars;
-    int status;
-    if (node->inital) {
-      ret = printInfo(a, true);
-      status = ret.first;
-      vars = ret.second;
-
-      if (status == -1) {
-        root.node->data.prune = MVOLP::FEAS;
-
-        break;
-      }
-      if (status == 1) {
-        node->upperBound = glp_get_obj_val(a);
-        root.node->data.prune = MVOLP::INTG;
+    const MVOLP::LPInfo &ret = result.info;
+    const std::vector<int> &vars = ret.violated;
+    MVOLP::NodeOutcome outcome = result.outcome;
+    if (node->inital && outcome == MVOLP::NodeOutcome::INFEASIBLE) {
+      root.node->data.prune = MVOLP::FEAS;
 
-        break;
-      }
-    } else {
-      ret = printInfo(a, false);
-      status = ret.first;
-      vars = ret.second;
+      break;
     }
-
-    node->upperBound = glp_get_obj_val(a);
-
-    if (status == 1) {
+    if (outcome == MVOLP::NodeOutcome::INTEGRAL) {
       // Prune by integrality
-      node->upperBound = glp_get_obj_val(a);
       root.node->data.prune = MVOLP::INTG;
 
       baseMsg.nodeType = MVOLP::EventType::integer;
@@ -177,21 +339,59 @@ int branchAndBound(glp_prob *prob, MVOLP::ParameterObj &params) {
                            ".  Updating best lower bound to ", bestLower))
             ->write();
 
-        solution = sstr("[", node->oid, "] Solution is: ");
-        for (int i = 1; i <= glp_get_num_cols(a); i++) {
-          if (glp_get_col_prim(a, i) != 0 && glp_get_obj_coef(a, i) != 0) {
-            solution += sstr((glp_get_obj_coef(a, i)), "*(x[", i,
-                             "] = ", (glp_get_col_prim(a, i)), ") + ");
-          }
+        solution = sstr("[", node->oid, "] Solution is: ", format(a));
+        if (race) {
+          race->incumbent.update(bestLower, solution);
+        }
+
+        // Drop every open node that can no longer beat the new incumbent at
+        // once, instead of re-solving and pruning them one at a time
+        std::vector<std::shared_ptr<MVOLP::NodeData>> dominated =
+            leafContainer->pruneBelow(params.cutoffBound(bestLower));
+        markPruned(dominated);
+        if (!dominated.empty()) {
+          logInfo
+              ->message(sstr("OID: ", node->oid, ".  Pruned ",
+                             dominated.size(), " dominated open nodes"))
+              ->write();
         }
 
-        // Constant (shift) term
-        solution +=
-            sstr(glp_get_obj_coef(a, 0), " = ", glp_get_obj_val(a), "\n");
+        if (rootCostsSaved) {
+          int fixed = 0;
+          double cutoff = params.cutoffBound(bestLower);
+          for (auto &i : rootCosts.fixings(cutoff)) {
+            double lb, ub;
+            getColBnds(prob, i.col, lb, ub);
+            if (i.lb > lb || i.ub < ub) {
+              tightenColBnds(prob, i.col, i.lb, i.ub);
+              fixed++;
+            }
+          }
+          if (fixed > 0) {
+            rootFixings += fixed;
+            processor.reset(prob);
+            logInfo
+                ->message(sstr("OID: ", node->oid, ".  Root reduced costs "
+                               "tightened ", fixed, " column bounds"))
+                ->write();
+
+            // Enough global fixings are worth dropping the tree for
+            int integers;
+            int fixedCols = countFixed({}, integers);
+            if (restartDue(fixedCols, integers)) {
+              int removed = restartSearch({}, subProblems.begin());
+              logInfo
+                  ->message(sstr("OID: ", node->oid,
+                                 ".  Restarting the search with ", fixedCols,
+                                 " of ", integers, " integer columns fixed, ",
+                                 removed, " columns removed"))
+                  ->write();
+            }
+          }
+        }
       }
 
-      leafContainer.erase(leafContainer.begin() + index);
-    } else if (status == -1) {
+    } else if (outcome == MVOLP::NodeOutcome::INFEASIBLE) {
       // Prune infeasible non-initial sub-problems
 
       root.node->data.prune = MVOLP::FEAS;
@@ -206,8 +406,17 @@ int branchAndBound(glp_prob *prob, MVOLP::ParameterObj &params) {
           ->message(sstr("OID: ", node->oid,
                          ".  Pruning non-initial infeasible node"))
           ->write();
-      leafContainer.erase(leafContainer.begin() + index);
-    } else if (glp_get_obj_val(a) <= bestLower) {
+
+      // Nodes already inside a conflict need no new one
+      if (!conflicts.entails(node->bounds, prob) &&
+          conflicts.analyze(node->bounds, processor.propagator(), prob,
+                            processor.scratch())) {
+        logDebug
+            ->message(sstr("OID: ", node->oid, ".  Learned conflict ",
+                           conflicts.size()))
+            ->write();
+      }
+    } else if (outcome == MVOLP::NodeOutcome::CUTOFF) {
       // Prune if node is worse then best lower bound
 
       root.node->data.prune = MVOLP::BNDS;
@@ -220,18 +429,12 @@ int branchAndBound(glp_prob *prob, MVOLP::ParameterObj &params) {
           ->message(sstr("OID: ", node->oid,
                          ".  Pruning worse lower-bounded node"))
           ->write();
-      leafContainer.erase(leafContainer.begin() + index);
     } else {
       baseMsg.nodeType = MVOLP::EventType::branched;
       mqDispatch->baseFields = baseMsg;
       mqDispatch->field6 = node->upperBound;
       mqDispatch->field7 = [&]() -> double {
-        double acc = 0;
-        for (auto &i : vars) {
-          if (i != 0) {
-            acc += getFract(glp_get_col_prim(a, i));
-          }
-        }
+        double acc = std::accumulate(ret.fract.begin(), ret.fract.end(), 0.0);
         if (acc == 0) {
           spdlog::error("acc is 0");
         }
@@ -243,8 +446,37 @@ int branchAndBound(glp_prob *prob, MVOLP::ParameterObj &params) {
       mqDispatch->field10 = 2;
       mqDispatch->write();
 
-      logDebug->message(sstr("Queue size is ", leafContainer.size()))->write();
-      leafContainer.erase(leafContainer.begin() + index);
+      logDebug->message(sstr("Queue size is ", leafContainer->size()))->write();
+
+      // Reduced cost fixing, before cuts are added to the LP.  The bounds go
+      // into the node's delta so the whole subtree inherits them
+      MVOLP::ReducedCosts costs = processor.fixReducedCosts(*node);
+      if (node->inital) {
+        rootCosts = costs;
+        rootCostsSaved = true;
+      }
+
+      // Restart once root processing has fixed enough integer columns,
+      // counting the reduced cost fixings just added to the node.  The
+      // root's bounds become part of the reduced model and the search starts
+      // over on it from a new root below the old one
+      if (node->inital) {
+        int integers;
+        int fixed = countFixed(node->bounds, integers);
+        if (restartDue(fixed, integers)) {
+          int removed = restartSearch(node->bounds, root);
+          logInfo
+              ->message(sstr("OID: ", node->oid, ".  Restarting the root with ",
+                             fixed, " of ", integers,
+                             " integer columns fixed, ", removed,
+                             " columns removed"))
+              ->write();
+          node->inital = false;
+
+          count++;
+          continue;
+        }
+      }
 
       if (params.IsCutEnabled()) {
         for (int j = 1; j <= glp_get_num_cols(a); j++) {
@@ -254,11 +486,28 @@ int branchAndBound(glp_prob *prob, MVOLP::ParameterObj &params) {
           }
         }
 
-        pool.addCutConstraint(a);
+        int cID = pool.addCutConstraint(a);
+        if (cID >= 0) {
+          // Children inherit the cut through their delta
+          node->addCut(pool.getCut(cID));
+        }
       }
 
-      int pick = params.pickVar(vars);
-      double bound = glp_get_col_prim(a, pick);
+      MVOLP::NodeResult branched = processor.branch(node, result);
+      if (branched.outcome == MVOLP::NodeOutcome::REEVALUATE) {
+        // Strong branching proved bounds on this node, so it is evaluated
+        // again with them instead of branching
+        leafContainer->push(node);
+        logInfo
+            ->message(sstr("OID: ", node->oid,
+                           ".  Re-evaluating node after strong branching"))
+            ->write();
+
+        count++;
+        continue;
+      }
+      int pick = branched.pick;
+      double bound = branched.value;
 
       std::string printMe = "Violated variables are: ";
       for (auto i : vars) {
@@ -266,26 +515,17 @@ int branchAndBound(glp_prob *prob, MVOLP::ParameterObj &params) {
       }
       logDebug->message(printMe)->write();
 
-      std::shared_ptr<MVOLP::NodeData> S2 =
-          std::make_shared<MVOLP::NodeData>(a);
-
-      std::shared_ptr<MVOLP::NodeData> S3 =
-          std::make_shared<MVOLP::NodeData>(a);
-      glp_set_col_bnds(S2->prob, pick, GLP_UP, 0, floor(bound));
+      std::shared_ptr<MVOLP::NodeData> S2 = branched.down;
+      std::shared_ptr<MVOLP::NodeData> S3 = branched.up;
       logInfo
           ->message(sstr("Adding constraint ", floor(bound), " >= x[", pick,
                          "] to object ", S2->oid))
           ->write();
-      glp_simplex(S2->prob, NULL);
-      S2->upperBound = glp_get_obj_val(S2->prob);
 
-      glp_set_col_bnds(S3->prob, pick, GLP_LO, ceil(bound), 0);
       logInfo
           ->message(sstr("Adding constraint ", ceil(bound), " <= ", "x[", pick,
                          "] to object ", S3->oid))
           ->write();
-      glp_simplex(S3->prob, NULL);
-      S3->upperBound = glp_get_obj_val(S3->prob);
 
       MVOLP::SPInfo sp = {S2->oid, MVOLP::NONE};
       subProblems.append_child(root, sp);
@@ -294,15 +534,15 @@ int branchAndBound(glp_prob *prob, MVOLP::ParameterObj &params) {
       treeIndex[S2->oid] = ++root;
       treeIndex[S3->oid] = ++root;
 
-      leafContainer.push_back(S2);
-      leafContainer.push_back(S3);
+      leafContainer->push(S2);
+      leafContainer->push(S3);
 
       MVOLP::BaseMessagePOD candidateData;
       mqDispatch->clearAll();
       candidateData.nodeType = MVOLP::EventType::candidate;
       candidateData.oid = S2->oid;
       candidateData.pid = getParentOid(subProblems, treeIndex[S2->oid]);
-      candidateData.direction = getBranchDirection(S2->oid);
+      candidateData.direction = getBranchDirection(treeIndex[S2->oid]);
       mqDispatch->baseFields = candidateData;
       mqDispatch->field6 = S2->upperBound;
       mqDispatch->write();
@@ -312,37 +552,87 @@ int branchAndBound(glp_prob *prob, MVOLP::ParameterObj &params) {
       candidateData2.nodeType = MVOLP::EventType::candidate;
       candidateData2.oid = S3->oid;
       candidateData2.pid = getParentOid(subProblems, treeIndex[S3->oid]);
-      candidateData2.direction = getBranchDirection(S3->oid);
+      candidateData2.direction = getBranchDirection(treeIndex[S3->oid]);
       mqDispatch->baseFields = candidateData2;
       mqDispatch->field6 = S3->upperBound;
       mqDispatch->write();
-
-      if (count > 200000) {
-        spdlog::error("Loop limit hit.  Returning early.");
-        std::exit(-1);
-      }
     }
 
     count++;
   }
 
-  std::cout
-      << "[I = Integral node, F = Infeasible node, B = Worse bound node]\n";
-  PrettyPrintTree(subProblems, subProblems.begin(), [](MVOLP::SPInfo &in) {
-    if (in.prune == MVOLP::INTG) {
-      return std::to_string(in.oid) + " I";
-    } else if (in.prune == MVOLP::FEAS) {
-      return std::to_string(in.oid) + " F";
-    } else if (in.prune == MVOLP::BNDS) {
-      return std::to_string(in.oid) + " B";
-    } else {
-      return std::to_string(in.oid);
-    }
-  });
+  // Racing searches leave the output to the race
+  if (!race) {
+    std::cout
+        << "[I = Integral node, F = Infeasible node, B = Worse bound node]\n";
+    PrettyPrintTree(subProblems, subProblems.begin(), [](MVOLP::SPInfo &in) {
+      if (in.prune == MVOLP::INTG) {
+        return std::to_string(in.oid) + " I";
+      } else if (in.prune == MVOLP::FEAS) {
+        return std::to_string(in.oid) + " F";
+      } else if (in.prune == MVOLP::BNDS) {
+        return std::to_string(in.oid) + " B";
+      } else {
+        return std::to_string(in.oid);
+      }
+    });
 
-  std::cout << sstr("\n", solution, "\n");
+    std::cout << sstr("\n", solution, "\n");
+  }
   logInfo->message(sstr("Solution found after ", count, " iterations"))
       ->write();
+  if (leafContainer->empty()) {
+    bestUpper = bestLower;
+  }
+  logInfo
+      ->message(sstr("Best lower bound ", bestLower, ", dual bound ", bestUpper,
+                     ", gap ", relativeGap(bestLower, bestUpper)))
+      ->write();
+  const MVOLP::NodeStats &stats = processor.stats;
+  logInfo
+      ->message(sstr("Node LPs solved on selection: ", stats.lpResolves))
+      ->write();
+  if (leafContainer->spillWrites() > 0) {
+    logInfo
+        ->message(sstr("Spilled ", leafContainer->spillWrites(),
+                       " open nodes to disk"))
+        ->write();
+  }
+  logInfo
+      ->message(sstr("Propagation: ", stats.propagatedInfeasible,
+                     " children infeasible without an LP, ",
+                     stats.propagatedBounds, " implied bounds"))
+      ->write();
+  logInfo
+      ->message(sstr("Conflicts: ", conflicts.size(), " stored, ",
+                     stats.conflictPrunes, " nodes pruned by them"))
+      ->write();
+  if (restarts > 0) {
+    logInfo
+        ->message(sstr("Restarts: ", restarts, ", final model has ",
+                       glp_get_num_cols(prob), " of ", reduced->origCols(),
+                       " columns"))
+        ->write();
+  }
+  logInfo
+      ->message(sstr("Reduced cost fixing: ", rootFixings, " global and ",
+                     stats.nodeFixings, " local bound changes"))
+      ->write();
+  params.reportStats();
+  if (stats.childSolves > 0) {
+    logInfo
+        ->message(sstr("Simplex iterations: ", stats.rootIterations,
+                       " at the root, ", stats.childIterations, " over ",
+                       stats.childSolves, " warm started child LPs (",
+                       (double)stats.childIterations / stats.childSolves,
+                       " per child)"))
+        ->write();
+  }
+
+  // Of several racing searches only the first to finish reports success
+  if (stopped || (race && race->stop.exchange(true))) {
+    return 1;
+  }
 
   return 0;
 }
@@ -4,5 +4,12 @@
 #include "util.h"
 #include "glpk.h"
 
-int branchAndBound(glp_prob *prob, MVOLP::ParameterObj &params);
+namespace MVOLP {
+struct RaceContext;
+}
+
+// Returns 0 once the search has finished, or 1 if it stopped at a limit or
+// another search of the race finished first
+int branchAndBound(glp_prob *prob, MVOLP::ParameterObj &params,
+                   MVOLP::RaceContext *race = nullptr);
 #endif
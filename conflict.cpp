@@ -0,0 +1,101 @@
+#include "conflict.h"
+
+#include <functional>
+
+bool MVOLP::ConflictPool::lpInfeasible(const std::vector<BoundChange> &bounds,
+                                       glp_prob *root, glp_prob *ws) const {
+  glp_copy_prob(ws, root, GLP_OFF);
+  for (auto &i : bounds) {
+    if (!tightenColBnds(ws, i.col, i.lb, i.ub)) {
+      return true;
+    }
+  }
+
+  glp_smcp parm;
+  glp_init_smcp(&parm);
+  parm.msg_lev = GLP_MSG_ERR;
+  parm.tol_bnd = _feasTol;
+  glp_std_basis(ws);
+
+  return glp_simplex(ws, &parm) == 0 && glp_get_status(ws) == GLP_NOFEAS;
+}
+
+/*
+ * Deletion filter: every change whose removal keeps the set infeasible is
+ * dropped for good, so one pass leaves a set in which each change is needed
+ * for the chosen test
+ */
+bool MVOLP::ConflictPool::analyze(const std::vector<BoundChange> &bounds,
+                                  Propagator &prop, glp_prob *root,
+                                  glp_prob *ws) {
+  std::vector<BoundChange> implied;
+  std::function<bool(const std::vector<BoundChange> &)> infeasible =
+      [&](const std::vector<BoundChange> &test) {
+        return !prop.propagate(test, implied);
+      };
+
+  if (!infeasible(bounds)) {
+    if (bounds.size() > _lpLimit) {
+      return false;
+    }
+    infeasible = [&](const std::vector<BoundChange> &test) {
+      return lpInfeasible(test, root, ws);
+    };
+    if (!infeasible(bounds)) {
+      // Infeasible only together with cuts
+      return false;
+    }
+  }
+
+  std::vector<BoundChange> conflict = bounds;
+  for (size_t i = 0; i < conflict.size();) {
+    std::vector<BoundChange> test = conflict;
+    test.erase(test.begin() + i);
+    if (infeasible(test)) {
+      conflict = test;
+    } else {
+      i++;
+    }
+  }
+
+  // An empty conflict would mean the root itself is infeasible
+  if (conflict.empty()) {
+    return false;
+  }
+
+  if (_conflicts.size() >= _maxConflicts) {
+    _conflicts.erase(_conflicts.begin());
+  }
+  _conflicts.push_back(conflict);
+
+  return true;
+}
+
+bool MVOLP::ConflictPool::entails(const std::vector<BoundChange> &bounds,
+                                  glp_prob *root) const {
+  for (auto &conflict : _conflicts) {
+    bool inside = true;
+    for (auto &i : conflict) {
+      double lb, ub;
+      getColBnds(root, i.col, lb, ub);
+      for (auto &j : bounds) {
+        if (j.col == i.col) {
+          lb = std::max(lb, j.lb);
+          ub = std::min(ub, j.ub);
+          break;
+        }
+      }
+
+      if (lb < i.lb || ub > i.ub) {
+        inside = false;
+        break;
+      }
+    }
+
+    if (inside) {
+      return true;
+    }
+  }
+
+  return false;
+}
@@ -0,0 +1,44 @@
+#ifndef CONFLICT_H
+#define CONFLICT_H
+
+#include "glpk.h"
+#include "propagate.h"
+#include "util.h"
+
+#include <vector>
+
+namespace MVOLP {
+/*
+ * Conflicts are conjunctions of bounds that no solution better than the
+ * incumbent satisfies.  Any node whose domain lies inside one is infeasible,
+ * wherever it is in the tree
+ */
+class ConflictPool {
+public:
+  // LPs judge infeasibility with the primal feasibility tolerance feasTol, as
+  // node LPs do
+  explicit ConflictPool(double feasTol) : _feasTol(feasTol) {}
+
+  // Shrinks the bound changes of an infeasible node to a small subset that is
+  // still infeasible and stores it.  Propagation is tried first, the LP of the
+  // root model (solved in ws) only for paths of at most lpLimit changes.
+  // Returns false if no conflict could be derived
+  bool analyze(const std::vector<BoundChange> &bounds, Propagator &prop,
+               glp_prob *root, glp_prob *ws);
+  // True if the node with this delta lies inside a stored conflict
+  bool entails(const std::vector<BoundChange> &bounds, glp_prob *root) const;
+  size_t size() const { return _conflicts.size(); }
+
+private:
+  std::vector<std::vector<BoundChange>> _conflicts;
+  size_t _lpLimit = 8;
+  double _feasTol;
+  // The oldest conflicts are dropped beyond this
+  size_t _maxConflicts = 1000;
+
+  bool lpInfeasible(const std::vector<BoundChange> &bounds, glp_prob *root,
+                    glp_prob *ws) const;
+};
+} // namespace MVOLP
+
+#endif
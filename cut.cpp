@@ -20,7 +20,6 @@ int CutPool::addCutConstraint(glp_prob *in, int cID) {
     cID = _cuts.size()-1;
   }
 
-  int index = glp_add_rows(in, 1);
   CutContainer selectedCut = _cuts.at(cID);
   assert(selectedCut.inds.size() == selectedCut.vals.size());
 
@@ -37,10 +36,17 @@ int CutPool::addCutConstraint(glp_prob *in, int cID) {
 
   spdlog::debug(sstr("Adding cut: ", printMe));
 
-  glp_set_mat_row(in, index, selectedCut.inds.size()-1, selectedCut.inds.data(),
-                  selectedCut.vals.data());
-  //glp_set_row_bnds(in, index, GLP_UP, 0, selectedCut.lb);
-  glp_set_row_bnds(in, index, GLP_LO, selectedCut.lb, 0);
+  addCutRow(in, selectedCut);
 
   return cID;
 }
+
+int addCutRow(glp_prob *in, const CutContainer &cut) {
+  int index = glp_add_rows(in, 1);
+  glp_set_mat_row(in, index, cut.inds.size()-1, cut.inds.data(),
+                  cut.vals.data());
+  //glp_set_row_bnds(in, index, GLP_UP, 0, cut.lb);
+  glp_set_row_bnds(in, index, GLP_LO, cut.lb, 0);
+
+  return index;
+}
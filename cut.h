@@ -12,12 +12,17 @@ struct CutContainer {
            // is from a problem of a greater depth than the current subproblem
 };
 
+// Appends the cut as a new row of the problem, returning the row index
+int addCutRow(glp_prob *in, const CutContainer &cut);
+
 class CutPool {
 public:
   int addToPool(CutContainer cut);
 
   int addCutConstraint(glp_prob *in, int cID = -1);
 
+  const CutContainer &getCut(int cID) const { return _cuts.at(cID); }
+
 private:
   std::vector<CutContainer> _cuts;
 };
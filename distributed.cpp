@@ -0,0 +1,318 @@
+#include "distributed.h"
+#include "nodequeue.h"
+#include "subtree.h"
+
+// std::max
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+// fork, waitpid
+#include <sys/wait.h>
+#include <unistd.h>
+// zmqpp::socket, zeroMQ
+#include <zmqpp/zmqpp.hpp>
+// info and debug
+#include "spdlog/spdlog.h"
+
+/*
+ * Protocol, one request/reply pair at a time:
+ *   worker  -> manager  RESULT id nodes incumbent solution node...
+ *   manager -> worker   WORK incumbent node | WAIT | DONE
+ * A worker that has nothing to report yet sends a RESULT without nodes.
+ * Doubles are sent as their raw bytes
+ */
+namespace {
+std::string packDouble(double value) {
+  return std::string(reinterpret_cast<const char *>(&value), sizeof(double));
+}
+
+double unpackDouble(const std::string &in) {
+  double value;
+  std::memcpy(&value, in.data(), sizeof(double));
+
+  return value;
+}
+
+std::string packNode(const MVOLP::NodeData &node) {
+  std::ostringstream out;
+  node.serialize(out);
+
+  return out.str();
+}
+
+std::shared_ptr<MVOLP::NodeData> unpackNode(const std::string &in,
+                                            glp_prob *prob) {
+  std::istringstream stream(in);
+
+  return MVOLP::NodeData::deserialize(stream, prob);
+}
+
+// A node handed out to a worker
+struct InFlight {
+  std::shared_ptr<MVOLP::NodeData> node;
+  std::chrono::high_resolution_clock::time_point since;
+};
+} // namespace
+
+/*
+ * The manager only moves nodes around.  A node handed to a worker stays in
+ * flight until that worker reports back, and its bound still counts towards
+ * the global dual bound.  A worker that has not reported back within timeout
+ * seconds, or a local worker that exited, is assumed lost and its node goes
+ * back into the pool
+ */
+int managerBranchAndBound(glp_prob *prob, MVOLP::ParameterObj &params,
+                          const std::string &endpoint, int localWorkers,
+                          long budget, double timeout) {
+  params.setObjStep(objectiveStep(prob), glp_get_obj_coef(prob, 0));
+
+  // ZeroMQ contexts do not survive a fork, so the workers are started before
+  // the manager creates its own.  Workers identify themselves by their pid
+  std::map<std::string, pid_t> children;
+  for (int i = 0; i < localWorkers; i++) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      workerBranchAndBound(prob, params, endpoint, budget);
+      _exit(0);
+    }
+    if (pid < 0) {
+      spdlog::error("Could not fork a local worker");
+      break;
+    }
+    children[std::to_string(pid)] = pid;
+  }
+
+  zmqpp::context context;
+  zmqpp::socket socket(context, zmqpp::socket_type::reply);
+  socket.set(zmqpp::socket_option::receive_timeout, 1000);
+  socket.bind(endpoint);
+  spdlog::info(sstr("Manager listening on ", endpoint));
+
+  std::unique_ptr<MVOLP::NodeQueue> pool = params.createNodeQueue();
+  std::shared_ptr<MVOLP::NodeData> S1 = std::make_shared<MVOLP::NodeData>(prob);
+  S1->inital = true;
+  pool->push(S1);
+
+  double incumbent = -std::numeric_limits<double>::infinity();
+  std::string solution = "";
+  // Node each worker is searching, and since when
+  std::map<std::string, InFlight> inFlight;
+  // Workers seen so far, those that still wait for their DONE, those already
+  // told to stop, and those whose node was given to someone else
+  std::set<std::string> workers;
+  std::set<std::string> awaiting;
+  std::set<std::string> released;
+  std::set<std::string> expired;
+  long count = 0;
+  bool finished = false;
+  auto begin = std::chrono::high_resolution_clock::now();
+
+  auto requeue = [&](const std::string &id) {
+    auto i = inFlight.find(id);
+    if (i == inFlight.end()) {
+      return;
+    }
+    if (i->second.node->upperBound > params.cutoffBound(incumbent)) {
+      pool->push(i->second.node);
+    }
+    inFlight.erase(i);
+  };
+
+  // Global dual bound over the pool and the nodes in flight
+  auto globalBound = [&]() {
+    double bound = pool->bestBound();
+    for (auto &i : inFlight) {
+      bound = std::max(bound, i.second.node->upperBound);
+    }
+
+    return bound;
+  };
+
+  // Every worker that has asked for work and was not lost since, and every
+  // local one that is still running, gets its DONE before the manager stops
+  auto waiting = [&]() {
+    if (!awaiting.empty()) {
+      return true;
+    }
+    for (auto &i : children) {
+      if (!released.count(i.first)) {
+        return true;
+      }
+    }
+
+    return false;
+  };
+
+  while (!finished || waiting()) {
+    auto now = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>(now - begin).count();
+
+    for (auto i = children.begin(); i != children.end();) {
+      if (waitpid(i->second, NULL, WNOHANG) != i->second) {
+        i++;
+        continue;
+      }
+      if (!released.count(i->first)) {
+        spdlog::warn(sstr("Local worker ", i->first, " exited"));
+        requeue(i->first);
+      }
+      awaiting.erase(i->first);
+      i = children.erase(i);
+    }
+    std::vector<std::string> overdue;
+    for (auto &i : inFlight) {
+      if (std::chrono::duration<double>(now - i.second.since).count() >
+          timeout) {
+        overdue.push_back(i.first);
+      }
+    }
+    for (auto &i : overdue) {
+      spdlog::warn(sstr("Worker ", i, " timed out, its node is queued again"));
+      requeue(i);
+      expired.insert(i);
+      // It is waited for again if it ever reports back
+      awaiting.erase(i);
+    }
+
+    if (!finished) {
+      double bound = globalBound();
+      std::string reason;
+      if (pool->empty() && inFlight.empty()) {
+        finished = true;
+      } else if (params.gapReached(incumbent, params.roundBound(bound))) {
+        spdlog::info(sstr("Optimality gap ", relativeGap(incumbent, bound),
+                          " within tolerance"));
+        finished = true;
+      } else if (params.limitReached(count, seconds, reason)) {
+        spdlog::info(sstr("Reached the ", reason, ".  Stopping"));
+        finished = true;
+      }
+    }
+
+    zmqpp::message request;
+    if (!socket.receive(request)) {
+      // Nobody asked for work within the timeout
+      continue;
+    }
+
+    std::string id = request.get(1);
+    workers.insert(id);
+    awaiting.insert(id);
+    count += std::stol(request.get(2));
+    inFlight.erase(id);
+    // The subtree of a worker that timed out is searched by someone else
+    bool late = expired.erase(id) > 0;
+
+    double value = unpackDouble(request.get(3));
+    if (value > incumbent) {
+      incumbent = value;
+      solution = request.get(4);
+      pool->pruneBelow(params.cutoffBound(incumbent));
+      spdlog::info(sstr("Worker ", id, " updated best lower bound to ",
+                        incumbent));
+    }
+    for (size_t i = 5; i < request.parts() && !late; i++) {
+      std::shared_ptr<MVOLP::NodeData> node = unpackNode(request.get(i), prob);
+      if (node->upperBound > params.cutoffBound(incumbent)) {
+        pool->push(node);
+      }
+    }
+
+    zmqpp::message reply;
+    if (finished) {
+      reply << "DONE";
+      released.insert(id);
+      awaiting.erase(id);
+    } else if (pool->empty()) {
+      reply << "WAIT";
+    } else {
+      std::shared_ptr<MVOLP::NodeData> node = pool->pop();
+      inFlight[id] = {node, std::chrono::high_resolution_clock::now()};
+      reply << "WORK";
+      reply.add(packDouble(incumbent));
+      reply.add(packNode(*node));
+    }
+    socket.send(reply);
+  }
+
+  for (auto &i : children) {
+    waitpid(i.second, NULL, 0);
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::high_resolution_clock::now() - begin)
+                       .count();
+
+  std::cout << sstr("\n", solution, "\n");
+  // Workers stopped by DONE returned their open nodes, which still bound the
+  // optimum after a limit
+  double bound = pool->empty() && inFlight.empty()
+                     ? incumbent
+                     : params.roundBound(globalBound());
+  spdlog::info(sstr("Best lower bound ", incumbent, ", dual bound ", bound,
+                    ", gap ", relativeGap(incumbent, bound)));
+  spdlog::info(sstr("Solution found after ", count, " iterations on ",
+                    workers.size(), " workers (", count / seconds,
+                    " nodes/s)"));
+
+  return 0;
+}
+
+/*
+ * Searches the subtree of every node it is given depth-first, with a warm
+ * started dual simplex, until the subtree is done or budget nodes have been
+ * processed.  Pseudocosts carry over between subtrees
+ */
+int workerBranchAndBound(glp_prob *prob, MVOLP::ParameterObj &params,
+                         const std::string &endpoint, long budget) {
+  params.setObjStep(objectiveStep(prob), glp_get_obj_coef(prob, 0));
+  std::string id = std::to_string(getpid());
+
+  zmqpp::context context;
+  zmqpp::socket socket(context, zmqpp::socket_type::request);
+  socket.connect(endpoint);
+
+  MVOLP::SubtreeSearch search(prob, params);
+
+  // Open nodes of the last subtree, sent with the next request
+  std::vector<std::shared_ptr<MVOLP::NodeData>> open;
+
+  while (true) {
+    zmqpp::message request;
+    request << "RESULT" << id << std::to_string(search.processed);
+    request.add(packDouble(search.found));
+    request.add(search.solution);
+    for (auto &i : open) {
+      request.add(packNode(*i));
+    }
+    socket.send(request);
+
+    search.processed = 0;
+    search.found = -std::numeric_limits<double>::infinity();
+    search.solution = "";
+    open.clear();
+
+    zmqpp::message reply;
+    socket.receive(reply);
+    std::string command = reply.get(0);
+    if (command == "DONE") {
+      break;
+    }
+    if (command == "WAIT") {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      continue;
+    }
+
+    double incumbent = unpackDouble(reply.get(1));
+    open = search.search(unpackNode(reply.get(2), prob), incumbent, budget);
+  }
+
+  params.reportStats();
+
+  return 0;
+}
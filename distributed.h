@@ -0,0 +1,26 @@
+#ifndef DISTRIBUTED_H
+#define DISTRIBUTED_H
+
+#include "glpk.h"
+#include "util.h"
+
+#include <string>
+
+/*
+ * Manager/worker branch and bound over ZeroMQ.  The manager keeps the global
+ * pool of open nodes and the incumbent, workers take one node at a time,
+ * search its subtree for at most a budget of nodes and send back the nodes
+ * they left open.  Nodes travel as their bound-change records, so every
+ * process must load the same model file.
+ *
+ * The manager forks localWorkers worker processes on this host, more can be
+ * started anywhere with --worker on the same endpoint (ipc:// or tcp://).
+ * The node of a worker silent for timeout seconds is handed to another one
+ */
+int managerBranchAndBound(glp_prob *prob, MVOLP::ParameterObj &params,
+                          const std::string &endpoint, int localWorkers,
+                          long budget, double timeout);
+int workerBranchAndBound(glp_prob *prob, MVOLP::ParameterObj &params,
+                         const std::string &endpoint, long budget);
+
+#endif
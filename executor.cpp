@@ -0,0 +1,61 @@
+#include "executor.h"
+#include "util.h"
+
+MVOLP::Executor::Executor(int threads) {
+  int term = getGlpTerm();
+  for (int i = 0; i < threads; i++) {
+    _threads.emplace_back(&Executor::run, this, term);
+  }
+}
+
+MVOLP::Executor::~Executor() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _quit = true;
+  }
+  _ready.notify_all();
+  for (auto &i : _threads) {
+    i.join();
+  }
+}
+
+void MVOLP::Executor::submit(std::function<void(glp_prob *ws)> task) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _tasks.push_back(std::move(task));
+    _pending++;
+  }
+  _ready.notify_one();
+}
+
+void MVOLP::Executor::wait() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  _idle.wait(lock, [&]() { return _pending == 0; });
+}
+
+void MVOLP::Executor::run(int term) {
+  GlpThreadEnv env(term);
+  glp_prob *ws = glp_create_prob();
+
+  while (true) {
+    std::function<void(glp_prob *)> task;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _ready.wait(lock, [&]() { return _quit || !_tasks.empty(); });
+      if (_tasks.empty()) {
+        break;
+      }
+      task = std::move(_tasks.front());
+      _tasks.pop_front();
+    }
+
+    task(ws);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (--_pending == 0) {
+      _idle.notify_all();
+    }
+  }
+
+  glp_delete_prob(ws);
+}
@@ -0,0 +1,46 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include "glpk.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MVOLP {
+/*
+ * Fixed set of threads running LP tasks for the serial search.  GLPK keeps
+ * its memory per thread, so every thread owns the workspace it hands to its
+ * tasks, and a task must not keep anything GLPK allocated in it
+ */
+class Executor {
+public:
+  Executor(int threads);
+  ~Executor();
+  Executor(const Executor &other) = delete;
+  Executor &operator=(const Executor &other) = delete;
+
+  // Queues task, which runs on one of the threads with that thread's
+  // workspace
+  void submit(std::function<void(glp_prob *ws)> task);
+  // Blocks until every task submitted so far is done
+  void wait();
+
+private:
+  std::vector<std::thread> _threads;
+  std::deque<std::function<void(glp_prob *)>> _tasks;
+  std::mutex _mutex;
+  std::condition_variable _ready;
+  std::condition_variable _idle;
+  // Tasks queued or running
+  int _pending = 0;
+  bool _quit = false;
+
+  void run(int term);
+};
+} // namespace MVOLP
+
+#endif
@@ -0,0 +1,238 @@
+#include "nodeproc.h"
+#include "rootsolve.h"
+
+// std::floor, std::ceil
+#include <cmath>
+#include <limits>
+
+MVOLP::NodeProcessor::NodeProcessor(glp_prob *prob, ParameterObj &params)
+    : _prob(prob), _params(params), _propagator(prob),
+      _incumbent(-std::numeric_limits<double>::infinity()) {
+  _a = glp_create_prob();
+  _b = glp_create_prob();
+
+  // A single bound change keeps the parent basis dual feasible, so children
+  // are re-optimized with the dual simplex starting from it
+  glp_init_smcp(&_warmParm);
+  _warmParm.meth = GLP_DUALP;
+  _warmParm.tol_bnd = params.getFeasTol();
+  glp_init_smcp(&_coldParm);
+  _coldParm.tol_bnd = params.getFeasTol();
+
+  if (params.getAsyncChildren()) {
+    _executor = std::make_unique<Executor>(2);
+  }
+}
+
+MVOLP::NodeProcessor::~NodeProcessor() {
+  glp_delete_prob(_a);
+  glp_delete_prob(_b);
+}
+
+void MVOLP::NodeProcessor::reset(glp_prob *prob) {
+  if (prob == _prob) {
+    _propagator.reset(prob);
+  } else {
+    _prob = prob;
+    _propagator = Propagator(prob);
+  }
+}
+
+/*
+ * Children were already solved when they were created, so their LP is only
+ * re-solved if the stored result can not be restored.  A child whose LP
+ * stopped at the objective cutoff is pruned by bound without rebuilding it
+ */
+MVOLP::NodeResult MVOLP::NodeProcessor::evaluate(NodeData &node,
+                                                 double incumbent) {
+  const double inf = std::numeric_limits<double>::infinity();
+  _incumbent = incumbent;
+  double cutoffValue = _params.cutoffBound(incumbent);
+  // The dual simplex stops as soon as a node LP can no longer beat the
+  // incumbent.  The solver only handles maximization
+  if (incumbent != -inf && glp_get_obj_dir(_prob) == GLP_MAX) {
+    _warmParm.obj_ll = cutoffValue;
+  }
+
+  bool cutoff = node.isCutoff();
+  // An empty column domain means the sub-problem is trivially infeasible
+  bool infeasible = node.isInfeasible() || (!cutoff && !node.buildProb(_a));
+  // Conflicts learned since the node was created
+  if (!infeasible && !cutoff && !node.inital && _conflicts &&
+      _conflicts->entails(node.bounds, _prob)) {
+    node.setInfeasible();
+    infeasible = true;
+    stats.conflictPrunes++;
+  }
+
+  _rootWinner.clear();
+  if (!infeasible && !cutoff && !node.loadLP(_a)) {
+    int before = glp_get_it_cnt(_a);
+    if (node.setBasis(_a)) {
+      cutoff = glp_simplex(_a, &_warmParm) == GLP_EOBJLL;
+    } else if (!node.inital || !_params.getConcurrentRoot() ||
+               concurrentSolve(_a, &_coldParm, _rootWinner) < 0) {
+      // A concurrent root solve leaves the winning basis in a, for the
+      // children to start from
+      glp_simplex(_a, &_coldParm);
+    }
+    if (node.inital) {
+      stats.rootIterations = glp_get_it_cnt(_a) - before;
+    }
+    stats.lpResolves++;
+  }
+
+  NodeResult result;
+  result.objVal =
+      node.isCutoff() || infeasible ? node.lp.objVal : glp_get_obj_val(_a);
+  if (infeasible) {
+    result.outcome = NodeOutcome::INFEASIBLE;
+  } else if (cutoff) {
+    result.outcome = NodeOutcome::CUTOFF;
+  } else {
+    result.info = printInfo(_a, node.inital, _params.getIntTol());
+    if (result.info.status == -1) {
+      result.outcome = NodeOutcome::INFEASIBLE;
+    } else if (result.info.status == 1) {
+      result.outcome = NodeOutcome::INTEGRAL;
+    } else if (result.objVal <= cutoffValue) {
+      result.outcome = NodeOutcome::CUTOFF;
+    } else {
+      result.outcome = NodeOutcome::FRACTIONAL;
+    }
+  }
+  node.upperBound = result.objVal;
+
+  return result;
+}
+
+MVOLP::ReducedCosts MVOLP::NodeProcessor::fixReducedCosts(NodeData &node) {
+  ReducedCosts costs;
+  costs.save(_a);
+  for (auto &i : costs.fixings(_params.cutoffBound(_incumbent))) {
+    double lb, ub;
+    getColBnds(_a, i.col, lb, ub);
+    if (i.lb > lb || i.ub < ub) {
+      node.addBound(i);
+      stats.nodeFixings++;
+    }
+  }
+
+  return costs;
+}
+
+bool MVOLP::NodeProcessor::prepareChild(NodeData &child) {
+  if (_conflicts && _conflicts->entails(child.bounds, _prob)) {
+    child.setInfeasible();
+    child.estimate = child.upperBound;
+    stats.conflictPrunes++;
+
+    return false;
+  }
+
+  std::vector<BoundChange> implied;
+  if (!_propagator.propagate(child.bounds, implied)) {
+    child.setInfeasible();
+    child.estimate = child.upperBound;
+    stats.propagatedInfeasible++;
+
+    return false;
+  }
+  for (auto &i : implied) {
+    child.addBound(i);
+  }
+  stats.propagatedBounds += implied.size();
+
+  return true;
+}
+
+// Only reads shared state, so siblings can be solved concurrently on
+// different workspaces
+int MVOLP::NodeProcessor::solveChild(NodeData &child, glp_prob *ws) {
+  int iterations = solveNode(child, ws, &_warmParm);
+  if (child.lp.status == GLP_OPT) {
+    child.estimate = _params.estimate(ws, child.upperBound);
+  } else {
+    child.estimate = child.upperBound;
+  }
+
+  return iterations;
+}
+
+MVOLP::NodeResult
+MVOLP::NodeProcessor::branch(std::shared_ptr<NodeData> node,
+                             const NodeResult &result) {
+  const double inf = std::numeric_limits<double>::infinity();
+  NodeResult out = result;
+
+  int pick = _params.pickVar(_a, result.info.violated);
+  if (pick < 0) {
+    for (auto &i : _params.takeFixings()) {
+      node->addBound(i);
+    }
+    node->saveBasis(_a);
+    out.outcome = NodeOutcome::REEVALUATE;
+
+    return out;
+  }
+
+  double value = glp_get_col_prim(_a, pick);
+  std::shared_ptr<NodeData> S2 = std::make_shared<NodeData>(
+      *node, BoundChange{pick, -inf, std::floor(value)});
+  std::shared_ptr<NodeData> S3 = std::make_shared<NodeData>(
+      *node, BoundChange{pick, std::ceil(value), inf});
+  S2->saveBasis(_a);
+  S3->saveBasis(_a);
+
+  // Conflicts and propagation share state and stay serial, only the LPs are
+  // handed to the executor.  Both are done before the caller sees them
+  int iterations[2] = {0, 0};
+  NodeData *children[2] = {S2.get(), S3.get()};
+  for (int i = 0; i < 2; i++) {
+    if (!prepareChild(*children[i])) {
+      continue;
+    }
+
+    stats.childSolves++;
+    if (_executor) {
+      _executor->submit([&, i](glp_prob *ws) {
+        iterations[i] = solveChild(*children[i], ws);
+      });
+    } else {
+      iterations[i] = solveChild(*children[i], _b);
+    }
+  }
+  if (_executor) {
+    _executor->wait();
+  }
+  stats.childIterations += iterations[0] + iterations[1];
+
+  // A probed pick was already recorded by strong branching
+  if (!_params.pickProbed()) {
+    _params.updatePseudoCost(pick, false, result.objVal - S2->upperBound,
+                             value - std::floor(value));
+    _params.updatePseudoCost(pick, true, result.objVal - S3->upperBound,
+                             std::ceil(value) - value);
+  }
+
+  out.outcome = NodeOutcome::BRANCHED;
+  out.pick = pick;
+  out.value = value;
+  out.down = S2;
+  out.up = S3;
+
+  return out;
+}
+
+MVOLP::NodeResult
+MVOLP::NodeProcessor::process(std::shared_ptr<NodeData> node,
+                              double incumbent) {
+  NodeResult result = evaluate(*node, incumbent);
+  if (result.outcome != NodeOutcome::FRACTIONAL) {
+    return result;
+  }
+
+  fixReducedCosts(*node);
+
+  return branch(node, result);
+}
@@ -0,0 +1,119 @@
+#ifndef NODEPROC_H
+#define NODEPROC_H
+
+#include "conflict.h"
+#include "executor.h"
+#include "glpk.h"
+#include "propagate.h"
+#include "redcost.h"
+#include "util.h"
+
+#include <memory>
+#include <string>
+
+namespace MVOLP {
+// What processing a node came to
+enum class NodeOutcome {
+  // Pruned by infeasibility, a conflict or propagation
+  INFEASIBLE,
+  // Pruned by bound against the incumbent
+  CUTOFF,
+  INTEGRAL,
+  // Fractional, to be branched on
+  FRACTIONAL,
+  // Strong branching proved bounds, so the node is evaluated again with them
+  // instead of branching
+  REEVALUATE,
+  BRANCHED
+};
+
+struct NodeResult {
+  NodeOutcome outcome;
+  // LP objective of the node, or its stored bound if it was pruned without
+  // an LP
+  double objVal;
+  LPInfo info;
+  // Branching column, its LP value, and the children, for BRANCHED
+  int pick = 0;
+  double value = 0;
+  std::shared_ptr<NodeData> down;
+  std::shared_ptr<NodeData> up;
+};
+
+// Counters of the work done by a NodeProcessor
+struct NodeStats {
+  long lpResolves = 0;
+  long rootIterations = 0;
+  long childIterations = 0;
+  long childSolves = 0;
+  long propagatedInfeasible = 0;
+  long propagatedBounds = 0;
+  long conflictPrunes = 0;
+  long nodeFixings = 0;
+};
+
+/*
+ * Processing of a single node, shared by every search mode: restoring or
+ * solving its LP, integrality, reduced cost fixing, and branching with
+ * propagated and solved children.  The modes differ only in how they pick
+ * nodes, share the incumbent and store the open nodes.  Owns its GLPK
+ * workspaces, so it must be created and used on the same thread
+ */
+class NodeProcessor {
+public:
+  NodeProcessor(glp_prob *prob, ParameterObj &params);
+  ~NodeProcessor();
+  NodeProcessor(const NodeProcessor &other) = delete;
+  NodeProcessor &operator=(const NodeProcessor &other) = delete;
+
+  // Re-reads prob after its bounds were tightened globally, or points the
+  // processor at a new model after a restart
+  void reset(glp_prob *prob);
+  // Nodes inside a conflict of the pool are pruned when it is set
+  void setConflicts(ConflictPool *conflicts) { _conflicts = conflicts; }
+
+  // Restores or solves the LP of node in lp() and checks it for integrality
+  // against incumbent.  FRACTIONAL nodes can still beat the incumbent
+  NodeResult evaluate(NodeData &node, double incumbent);
+  // Adds the bounds the reduced costs of the node LP imply for the incumbent
+  // of the last evaluate to the node's delta, so its subtree inherits them.
+  // Returns the reduced costs
+  ReducedCosts fixReducedCosts(NodeData &node);
+  // Picks a branching column for a FRACTIONAL node and creates its solved
+  // children.  Returns REEVALUATE or BRANCHED
+  NodeResult branch(std::shared_ptr<NodeData> node, const NodeResult &result);
+  // All of the above, for searches without anything in between
+  NodeResult process(std::shared_ptr<NodeData> node, double incumbent);
+
+  // LP of the node last evaluated
+  glp_prob *lp() const { return _a; }
+  // Scratch workspace, free between calls
+  glp_prob *scratch() const { return _b; }
+  Propagator &propagator() { return _propagator; }
+  // Method that solved the last root LP first with --concurrent-root
+  const std::string &rootWinner() const { return _rootWinner; }
+
+  NodeStats stats;
+
+private:
+  glp_prob *_prob;
+  ParameterObj &_params;
+  // a holds the node being processed, b evaluates its children
+  glp_prob *_a;
+  glp_prob *_b;
+  glp_smcp _warmParm;
+  glp_smcp _coldParm;
+  Propagator _propagator;
+  ConflictPool *_conflicts = nullptr;
+  // Solves the two children of a branching at once with --async-children
+  std::unique_ptr<Executor> _executor;
+  double _incumbent;
+  std::string _rootWinner;
+
+  // Returns false if conflicts or propagation prove child infeasible
+  bool prepareChild(NodeData &child);
+  int solveChild(NodeData &child, glp_prob *ws);
+};
+} // namespace MVOLP
+
+#endif
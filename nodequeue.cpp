@@ -0,0 +1,399 @@
+#include "nodequeue.h"
+
+// std::remove_if
+#include <algorithm>
+// std::remove (file)
+#include <cstdio>
+// std::numeric_limits
+#include <limits>
+// error
+#include "spdlog/spdlog.h"
+
+MVOLP::NodeQueue::~NodeQueue() {
+  if (_spill.is_open()) {
+    _spill.close();
+    std::remove(_spillPath.c_str());
+  }
+}
+
+void MVOLP::NodeQueue::setMemBudget(size_t budget, const std::string &path) {
+  _memBudget = budget;
+  _spillPath = path;
+}
+
+void MVOLP::NodeQueue::push(std::shared_ptr<NodeData> node) {
+  _recent.push_back(insert(std::move(node)));
+
+  if (_memBudget > 0 && _memUsed > _memBudget) {
+    evict();
+  }
+}
+
+int MVOLP::NodeQueue::insert(std::shared_ptr<NodeData> node) {
+  int slot;
+  if (_free.empty()) {
+    slot = _nodes.size();
+    _nodes.push_back(nullptr);
+    _keys.push_back(NodeKey());
+    _sizes.push_back(0);
+  } else {
+    slot = _free.back();
+    _free.pop_back();
+  }
+
+  _keys[slot] = {node->upperBound, node->estimate, node->depth};
+  _sizes[slot] = node->memoryUsage();
+  _memUsed += _sizes[slot];
+  _nodes[slot] = std::move(node);
+  _count++;
+  _byBound.insert({_keys[slot].bound, slot});
+
+  insertSlot(slot);
+
+  return slot;
+}
+
+std::shared_ptr<MVOLP::NodeData> MVOLP::NodeQueue::pop() {
+  _recent.clear();
+  refill();
+
+  return release(popSlot());
+}
+
+std::shared_ptr<MVOLP::NodeData> MVOLP::NodeQueue::popBestBound() {
+  _recent.clear();
+  refill();
+  int slot = _byBound.rbegin()->second;
+  eraseSlot(slot);
+
+  return release(slot);
+}
+
+std::shared_ptr<MVOLP::NodeData> MVOLP::NodeQueue::remove(int slot) {
+  _recent.clear();
+  eraseSlot(slot);
+
+  return release(slot);
+}
+
+// Frees a slot that has already been taken out of the ordering
+std::shared_ptr<MVOLP::NodeData> MVOLP::NodeQueue::release(int slot) {
+  _byBound.erase({_keys[slot].bound, slot});
+  std::shared_ptr<NodeData> node = std::move(_nodes[slot]);
+  _nodes[slot] = nullptr;
+  _free.push_back(slot);
+  _memUsed -= _sizes[slot];
+  _count--;
+
+  return node;
+}
+
+void MVOLP::NodeQueue::releaseSlots(const std::vector<bool> &dead,
+                                    size_t count) {
+  for (size_t slot = 0; slot < dead.size(); slot++) {
+    if (dead[slot]) {
+      _free.push_back(slot);
+      _memUsed -= _sizes[slot];
+    }
+  }
+  _count -= count;
+  _recent.erase(std::remove_if(_recent.begin(), _recent.end(),
+                               [&](int slot) { return dead[slot]; }),
+                _recent.end());
+
+  removeSlots(dead);
+}
+
+double MVOLP::NodeQueue::bestBound() const {
+  double best = -std::numeric_limits<double>::infinity();
+  if (!_byBound.empty()) {
+    best = _byBound.rbegin()->first;
+  }
+  if (!_spillIndex.empty()) {
+    best = std::max(best, _spillIndex.rbegin()->first);
+  }
+
+  return best;
+}
+
+std::vector<std::shared_ptr<MVOLP::NodeData>>
+MVOLP::NodeQueue::pruneBelow(double value) {
+  std::vector<std::shared_ptr<NodeData>> pruned;
+  while (!_spillIndex.empty() && _spillIndex.begin()->first <= value) {
+    pruned.push_back(readSpilled(_spillIndex.begin()->second));
+    _spillIndex.erase(_spillIndex.begin());
+  }
+  reclaimSpill();
+
+  auto end = _byBound.upper_bound({value, std::numeric_limits<int>::max()});
+  if (end == _byBound.begin()) {
+    return pruned;
+  }
+
+  std::vector<bool> dead(_nodes.size(), false);
+  size_t count = 0;
+  for (auto i = _byBound.begin(); i != end; i++) {
+    int slot = i->second;
+    dead[slot] = true;
+    pruned.push_back(std::move(_nodes[slot]));
+    _nodes[slot] = nullptr;
+    count++;
+  }
+  _byBound.erase(_byBound.begin(), end);
+  releaseSlots(dead, count);
+
+  return pruned;
+}
+
+/*
+ * Writes the worst-bound nodes to the spill file until memory is back at 80%
+ * of the budget, keeping at least one node in memory
+ */
+void MVOLP::NodeQueue::evict() {
+  if (!_spill.is_open()) {
+    _spill.open(_spillPath, std::ios::in | std::ios::out | std::ios::trunc |
+                                std::ios::binary);
+    if (!_spill.is_open()) {
+      spdlog::error(sstr("Could not open spill file ", _spillPath,
+                         ", keeping all open nodes in memory"));
+      _memBudget = 0;
+      return;
+    }
+  }
+
+  size_t target = _memBudget / 5 * 4;
+  size_t used = _memUsed;
+  std::vector<bool> dead(_nodes.size(), false);
+  size_t count = 0;
+  auto i = _byBound.begin();
+  _spill.clear();
+  _spill.seekp(0, std::ios::end);
+  for (; used > target && _count - count > 1; ++i) {
+    int slot = i->second;
+    std::streamoff offset = _spill.tellp();
+    _spillRoot = _nodes[slot]->root();
+    _nodes[slot]->serialize(_spill);
+    _spillEnd = _spill.tellp();
+    _spillIndex.insert({_keys[slot].bound, {offset, _spillEnd - offset}});
+    _spillLive += _spillEnd - offset;
+    _nodes[slot] = nullptr;
+    dead[slot] = true;
+    used -= _sizes[slot];
+    count++;
+  }
+  _byBound.erase(_byBound.begin(), i);
+  _spillWrites += count;
+
+  releaseSlots(dead, count);
+}
+
+/*
+ * Spilled nodes come back once one of them has the best bound, or memory has
+ * run empty.  They are read best first, up to half the budget at a time, so
+ * the next few pops do not touch the file again
+ */
+void MVOLP::NodeQueue::refill() {
+  if (_spillIndex.empty() ||
+      (_count > 0 && _spillIndex.rbegin()->first <= _byBound.rbegin()->first)) {
+    return;
+  }
+
+  do {
+    auto best = std::prev(_spillIndex.end());
+    std::shared_ptr<NodeData> node = readSpilled(best->second);
+    _spillIndex.erase(best);
+    insert(std::move(node));
+  } while (!_spillIndex.empty() && _memUsed < _memBudget / 2);
+  reclaimSpill();
+}
+
+std::shared_ptr<MVOLP::NodeData>
+MVOLP::NodeQueue::readSpilled(const SpillRecord &record) {
+  _spillLive -= record.size;
+  _spill.clear();
+  _spill.seekg(record.offset);
+
+  return NodeData::deserialize(_spill, _spillRoot);
+}
+
+/*
+ * Nodes read back leave holes in the spill file.  It is emptied once no
+ * spilled node is left, and rewritten with only the open ones once the holes
+ * take more than half of it, so it stays within twice their size
+ */
+void MVOLP::NodeQueue::reclaimSpill() {
+  if (!_spill.is_open() || _spillLive * 2 >= _spillEnd) {
+    return;
+  }
+
+  const auto mode = std::ios::in | std::ios::out | std::ios::binary;
+  if (_spillIndex.empty()) {
+    _spill.close();
+    _spill.open(_spillPath, mode | std::ios::trunc);
+    _spillLive = 0;
+    _spillEnd = 0;
+    return;
+  }
+
+  std::string path = _spillPath + ".tmp";
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  std::vector<std::streamoff> offsets;
+  std::vector<char> buffer;
+  std::streamoff end = 0;
+  for (auto &i : _spillIndex) {
+    buffer.resize(i.second.size);
+    _spill.clear();
+    _spill.seekg(i.second.offset);
+    _spill.read(buffer.data(), buffer.size());
+    out.write(buffer.data(), buffer.size());
+    offsets.push_back(end);
+    end += i.second.size;
+  }
+  out.close();
+  if (!out || !_spill) {
+    spdlog::warn(sstr("Could not compact spill file ", _spillPath));
+    std::remove(path.c_str());
+    return;
+  }
+
+  _spill.close();
+  if (std::rename(path.c_str(), _spillPath.c_str()) != 0) {
+    spdlog::warn(sstr("Could not compact spill file ", _spillPath));
+    std::remove(path.c_str());
+    _spill.open(_spillPath, mode);
+    return;
+  }
+  _spill.open(_spillPath, mode);
+
+  size_t k = 0;
+  for (auto &i : _spillIndex) {
+    i.second.offset = offsets[k++];
+  }
+  _spillEnd = end;
+}
+
+void MVOLP::HeapNodeQueue::insertSlot(int slot) {
+  if ((size_t)slot >= _pos.size()) {
+    _pos.resize(slot + 1);
+  }
+  _heap.push_back(slot);
+  _pos[slot] = _heap.size() - 1;
+  siftUp(_heap.size() - 1);
+}
+
+int MVOLP::HeapNodeQueue::popSlot() {
+  int slot = _heap.front();
+  eraseSlot(slot);
+
+  return slot;
+}
+
+void MVOLP::HeapNodeQueue::eraseSlot(int slot) {
+  size_t i = _pos[slot];
+  int last = _heap.back();
+  _heap.pop_back();
+  if (i == _heap.size()) {
+    return;
+  }
+
+  // Move the last entry into the hole and repair in whichever direction
+  place(i, last);
+  siftUp(i);
+  siftDown(_pos[last]);
+}
+
+void MVOLP::HeapNodeQueue::place(size_t i, int slot) {
+  _heap[i] = slot;
+  _pos[slot] = i;
+}
+
+void MVOLP::HeapNodeQueue::siftUp(size_t i) {
+  while (i > 0) {
+    size_t parent = (i - 1) / 2;
+    if (!_better(_keys[_heap[i]], _keys[_heap[parent]])) {
+      break;
+    }
+    int slot = _heap[i];
+    place(i, _heap[parent]);
+    place(parent, slot);
+    i = parent;
+  }
+}
+
+void MVOLP::HeapNodeQueue::siftDown(size_t i) {
+  size_t n = _heap.size();
+  while (true) {
+    size_t best = i;
+    size_t left = 2 * i + 1;
+    size_t right = left + 1;
+    if (left < n && _better(_keys[_heap[left]], _keys[_heap[best]])) {
+      best = left;
+    }
+    if (right < n && _better(_keys[_heap[right]], _keys[_heap[best]])) {
+      best = right;
+    }
+    if (best == i) {
+      break;
+    }
+    int slot = _heap[i];
+    place(i, _heap[best]);
+    place(best, slot);
+    i = best;
+  }
+}
+
+void MVOLP::HeapNodeQueue::removeSlots(const std::vector<bool> &dead) {
+  _heap.erase(std::remove_if(_heap.begin(), _heap.end(),
+                             [&](int slot) { return dead[slot]; }),
+              _heap.end());
+  for (size_t i = 0; i < _heap.size(); i++) {
+    _pos[_heap[i]] = i;
+  }
+
+  // Restore the heap property bottom-up
+  for (size_t i = _heap.size() / 2; i-- > 0;) {
+    siftDown(i);
+  }
+}
+
+void MVOLP::StackNodeQueue::removeSlots(const std::vector<bool> &dead) {
+  _stack.erase(std::remove_if(_stack.begin(), _stack.end(),
+                              [&](int slot) { return dead[slot]; }),
+               _stack.end());
+}
+
+void MVOLP::StackNodeQueue::eraseSlot(int slot) {
+  // Plunging removes recently pushed slots, which sit at the back
+  for (size_t i = _stack.size(); i-- > 0;) {
+    if (_stack[i] == slot) {
+      _stack.erase(_stack.begin() + i);
+      return;
+    }
+  }
+}
+
+int MVOLP::StackNodeQueue::popSlot() {
+  int slot = _stack.back();
+  _stack.pop_back();
+
+  return slot;
+}
+
+// Greatest LP bound first, deeper nodes first on ties
+bool MVOLP::betterBound(const NodeKey &lhs, const NodeKey &rhs) {
+  if (lhs.bound != rhs.bound) {
+    return lhs.bound > rhs.bound;
+  }
+
+  return lhs.depth > rhs.depth;
+}
+
+// Greatest estimate of the best integer solution first, deeper nodes first on
+// ties
+bool MVOLP::betterEstimate(const NodeKey &lhs, const NodeKey &rhs) {
+  if (lhs.estimate != rhs.estimate) {
+    return lhs.estimate > rhs.estimate;
+  }
+
+  return lhs.depth > rhs.depth;
+}
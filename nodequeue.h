@@ -0,0 +1,153 @@
+#ifndef NODEQUEUE_H
+#define NODEQUEUE_H
+
+#include "util.h"
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace MVOLP {
+// Selection keys of an open node.  They are kept in their own contiguous array
+// so that ordering the open nodes never touches the (much larger) NodeData
+struct NodeKey {
+  double bound;
+  double estimate;
+  int depth;
+};
+
+/*
+ * Container of the open nodes of the search.  Nodes live in slots that are
+ * reused once freed, and each strategy only orders slot indices by their
+ * NodeKey.  push and pop are O(log n) for the heap and O(1) for the stack.
+ */
+class NodeQueue {
+public:
+  virtual ~NodeQueue();
+
+  void push(std::shared_ptr<NodeData> node);
+  std::shared_ptr<NodeData> pop();
+  // Takes the node with the best bound, whatever the order of the strategy
+  std::shared_ptr<NodeData> popBestBound();
+
+  // Open nodes, including the spilled ones
+  size_t size() const { return _count + _spillIndex.size(); }
+  bool empty() const { return size() == 0; }
+
+  // Once the open nodes take more than budget bytes, the worst-bound ones are
+  // written to a spill file at path and read back when they hold the best
+  // bound, or nothing else is left.  A budget of 0 keeps every node in memory
+  void setMemBudget(size_t budget, const std::string &path);
+  long spillWrites() const { return _spillWrites; }
+
+  // Greatest LP bound among the open nodes (the global dual bound), or -inf
+  // if there are none.  Maintained on every push and pop
+  double bestBound() const;
+
+  // Removes every open node whose bound is no better than value and returns
+  // them.  The nodes are found by splitting the bound-ordered set, so this
+  // costs O(k log n) plus one O(n) pass of the strategy's structure
+  std::vector<std::shared_ptr<NodeData>> pruneBelow(double value);
+
+  // Slots pushed since the last pop, i.e. the children of the node being
+  // processed.  Used for plunging
+  const std::vector<int> &recent() const { return _recent; }
+  const NodeKey &key(int slot) const { return _keys[slot]; }
+  // Takes a specific open node out of the queue
+  std::shared_ptr<NodeData> remove(int slot);
+
+protected:
+  std::vector<NodeKey> _keys;
+
+  virtual void insertSlot(int slot) = 0;
+  virtual int popSlot() = 0;
+  // Drops every slot flagged in dead from the ordering
+  virtual void removeSlots(const std::vector<bool> &dead) = 0;
+  virtual void eraseSlot(int slot) = 0;
+
+private:
+  std::vector<std::shared_ptr<NodeData>> _nodes;
+  std::vector<int> _free;
+  size_t _count = 0;
+  // (bound, slot) of every open node, whatever order the strategy uses
+  std::set<std::pair<double, int>> _byBound;
+  std::vector<int> _recent;
+
+  // Bytes used by the node in every slot, and their total
+  std::vector<size_t> _sizes;
+  size_t _memUsed = 0;
+  size_t _memBudget = 0;
+  std::string _spillPath;
+  std::fstream _spill;
+  glp_prob *_spillRoot = nullptr;
+  // Where every spilled node is in the file, by bound
+  struct SpillRecord {
+    std::streamoff offset;
+    std::streamoff size;
+  };
+  std::multimap<double, SpillRecord> _spillIndex;
+  // Bytes of the spilled nodes still open, and of the whole file
+  std::streamoff _spillLive = 0;
+  std::streamoff _spillEnd = 0;
+  long _spillWrites = 0;
+
+  // Adds a node to memory without marking it as recently pushed.  Returns its
+  // slot
+  int insert(std::shared_ptr<NodeData> node);
+  std::shared_ptr<NodeData> release(int slot);
+  // Drops the slots flagged in dead from the bookkeeping and the ordering.
+  // The nodes must already have been moved out
+  void releaseSlots(const std::vector<bool> &dead, size_t count);
+  void evict();
+  void refill();
+  // Reads back a spilled node.  Its record has to be erased by the caller
+  std::shared_ptr<NodeData> readSpilled(const SpillRecord &record);
+  void reclaimSpill();
+};
+
+// Returns true if lhs should be picked before rhs
+typedef bool (*KeyCompare)(const NodeKey &lhs, const NodeKey &rhs);
+
+// Binary heap of slots, used for best-first selection
+class HeapNodeQueue : public NodeQueue {
+public:
+  HeapNodeQueue(KeyCompare better) : _better(better) {}
+
+protected:
+  void insertSlot(int slot) override;
+  int popSlot() override;
+  void removeSlots(const std::vector<bool> &dead) override;
+  void eraseSlot(int slot) override;
+
+private:
+  KeyCompare _better;
+  std::vector<int> _heap;
+  // Position of every slot in _heap
+  std::vector<size_t> _pos;
+
+  void place(size_t i, int slot);
+  void siftUp(size_t i);
+  void siftDown(size_t i);
+};
+
+// LIFO stack of slots, used for depth-first selection
+class StackNodeQueue : public NodeQueue {
+protected:
+  void insertSlot(int slot) override { _stack.push_back(slot); }
+  int popSlot() override;
+  void removeSlots(const std::vector<bool> &dead) override;
+  void eraseSlot(int slot) override;
+
+private:
+  std::vector<int> _stack;
+};
+
+bool betterBound(const NodeKey &lhs, const NodeKey &rhs);
+bool betterEstimate(const NodeKey &lhs, const NodeKey &rhs);
+} // namespace MVOLP
+
+#endif
@@ -0,0 +1,589 @@
+#include "parallel.h"
+#include "bs.h"
+#include "nodeproc.h"
+#include "subtree.h"
+#include "util.h"
+
+// std::remove_if
+#include <algorithm>
+// std::trunc()
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+// info and debug
+#include "spdlog/spdlog.h"
+
+bool MVOLP::SharedIncumbent::update(double value, const std::string &solution) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (value <= _value.load()) {
+    return false;
+  }
+
+  _value = value;
+  _solution = solution;
+
+  return true;
+}
+
+std::string MVOLP::SharedIncumbent::solution() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  return _solution;
+}
+
+namespace {
+// Open nodes owned by one worker.  The owner works depth-first from the back,
+// thieves take the oldest (shallowest) nodes from the front
+struct WorkerQueue {
+  std::mutex mutex;
+  std::deque<std::shared_ptr<MVOLP::NodeData>> nodes;
+};
+
+struct WorkerStats {
+  long nodes = 0;
+  long steals = 0;
+};
+} // namespace
+
+/*
+ * Parallel version of branchAndBound.  Every worker thread has its own GLPK
+ * workspace and node deque, and idle workers steal from the others.  The
+ * incumbent is shared so a solution found by one worker prunes everywhere.
+ * Cut generation, conflict learning, global reduced cost fixing from the
+ * root, restarts, the tree printout and the IPC server are only available in
+ * the serial search.
+ */
+int parallelBranchAndBound(glp_prob *prob, MVOLP::ParameterObj &params,
+                           int threads) {
+  std::vector<WorkerQueue> queues(threads);
+  std::vector<WorkerStats> stats(threads);
+  MVOLP::SharedIncumbent incumbent;
+  params.setObjStep(objectiveStep(prob), glp_get_obj_coef(prob, 0));
+
+  // Nodes that are queued or being processed.  The search is over once it
+  // drops to zero, since only a node in progress can create new ones
+  std::atomic<long> pending = 1;
+  std::atomic<long> count = 0;
+  std::atomic<bool> stop = false;
+
+  // Bound of the node each worker is processing, -inf while it has none.  It
+  // is set before the node leaves its queue and cleared after its children
+  // are in one, so every open node is always counted somewhere
+  const double inf = std::numeric_limits<double>::infinity();
+  std::vector<std::atomic<double>> active(threads);
+  for (auto &i : active) {
+    i = -inf;
+  }
+
+  // Idle workers sleep until a node is pushed or the search ends.  epoch
+  // changes under the mutex with every such event, so none is missed between
+  // a failed steal and the wait
+  std::mutex idleMutex;
+  std::condition_variable wake;
+  std::atomic<long> epoch = 0;
+  auto signal = [&](bool all) {
+    {
+      std::lock_guard<std::mutex> lock(idleMutex);
+      epoch++;
+    }
+    if (all) {
+      wake.notify_all();
+    } else {
+      wake.notify_one();
+    }
+  };
+
+  int term = getGlpTerm();
+  auto begin = std::chrono::high_resolution_clock::now();
+
+  std::shared_ptr<MVOLP::NodeData> S1 = std::make_shared<MVOLP::NodeData>(prob);
+  S1->inital = true;
+  queues[0].nodes.push_back(S1);
+
+  auto takeNode = [&](int w, std::mt19937 &rng) {
+    std::shared_ptr<MVOLP::NodeData> node;
+    {
+      std::lock_guard<std::mutex> lock(queues[w].mutex);
+      if (!queues[w].nodes.empty()) {
+        node = queues[w].nodes.back();
+        queues[w].nodes.pop_back();
+        active[w] = node->upperBound;
+
+        return node;
+      }
+    }
+
+    int start = rng() % threads;
+    for (int i = 0; i < threads; i++) {
+      int victim = (start + i) % threads;
+      if (victim == w) {
+        continue;
+      }
+
+      std::lock_guard<std::mutex> lock(queues[victim].mutex);
+      if (!queues[victim].nodes.empty()) {
+        node = queues[victim].nodes.front();
+        queues[victim].nodes.pop_front();
+        active[w] = node->upperBound;
+        stats[w].steals++;
+
+        return node;
+      }
+    }
+
+    return node;
+  };
+
+  // Global dual bound over the queues of all workers and the nodes they are
+  // processing.  Holding every queue keeps nodes from moving during the scan
+  auto globalBound = [&]() {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    for (auto &q : queues) {
+      locks.emplace_back(q.mutex);
+    }
+
+    double bound = -inf;
+    for (int w = 0; w < threads; w++) {
+      bound = std::max(bound, active[w].load());
+      for (auto &i : queues[w].nodes) {
+        bound = std::max(bound, i->upperBound);
+      }
+    }
+
+    return bound;
+  };
+
+  auto worker = [&](int w) {
+    MVOLP::GlpThreadEnv env(term);
+    MVOLP::ParameterObj local = params;
+    MVOLP::NodeProcessor processor(prob, local);
+    std::mt19937 rng(w);
+
+    while (pending > 0 && !stop) {
+      long seen = epoch;
+      std::shared_ptr<MVOLP::NodeData> node = takeNode(w, rng);
+      if (!node) {
+        std::unique_lock<std::mutex> lock(idleMutex);
+        wake.wait(lock,
+                  [&]() { return epoch != seen || pending == 0 || stop; });
+        continue;
+      }
+
+      // Node LPs stop at the objective cutoff of the shared incumbent
+      MVOLP::NodeResult result = processor.process(node, incumbent.value());
+      bool improved =
+          result.outcome == MVOLP::NodeOutcome::INTEGRAL &&
+          incumbent.update(result.objVal,
+                           sstr("[", node->oid, "] Solution is: ",
+                                formatSolution(processor.lp())));
+      if (improved) {
+        spdlog::info(sstr("OID: ", node->oid, ".  Worker ", w,
+                          " updated best lower bound to ", result.objVal));
+
+        // Drop the open nodes of every worker that can no longer beat the
+        // new incumbent
+        double cutoff = local.cutoffBound(result.objVal);
+        long dominated = 0;
+        for (auto &q : queues) {
+          std::lock_guard<std::mutex> lock(q.mutex);
+          size_t before = q.nodes.size();
+          q.nodes.erase(
+              std::remove_if(q.nodes.begin(), q.nodes.end(),
+                             [&](const std::shared_ptr<MVOLP::NodeData> &i) {
+                               return i->upperBound <= cutoff;
+                             }),
+              q.nodes.end());
+          dominated += before - q.nodes.size();
+        }
+        pending -= dominated;
+      } else if (result.outcome == MVOLP::NodeOutcome::REEVALUATE) {
+        pending++;
+        std::lock_guard<std::mutex> lock(queues[w].mutex);
+        queues[w].nodes.push_back(node);
+      } else if (result.outcome == MVOLP::NodeOutcome::BRANCHED) {
+        pending += 2;
+        {
+          std::lock_guard<std::mutex> lock(queues[w].mutex);
+          queues[w].nodes.push_back(result.down);
+          queues[w].nodes.push_back(result.up);
+        }
+        // This worker takes one of the children itself
+        signal(false);
+      }
+
+      active[w] = -inf;
+      stats[w].nodes++;
+      if (--pending == 0) {
+        signal(true);
+      }
+
+      std::string reason;
+      double seconds = std::chrono::duration<double>(
+                           std::chrono::high_resolution_clock::now() - begin)
+                           .count();
+      long processed = ++count;
+      if (local.limitReached(processed, seconds, reason) &&
+          !stop.exchange(true)) {
+        spdlog::info(sstr("Reached the ", reason, ".  Stopping"));
+        signal(true);
+      }
+
+      // The global bound locks every queue, so it is only checked against
+      // a new incumbent and every 64 nodes
+      if (improved || processed % 64 == 0) {
+        double best = incumbent.value();
+        double bound = local.roundBound(globalBound());
+        if (local.gapReached(best, bound) && !stop.exchange(true)) {
+          spdlog::info(sstr("Optimality gap ", relativeGap(best, bound),
+                            " (", bound - best,
+                            " absolute) within tolerance.  Stopping"));
+          signal(true);
+        }
+      }
+    }
+
+    local.reportStats();
+  };
+
+  std::vector<std::thread> pool;
+  for (int w = 0; w < threads; w++) {
+    pool.emplace_back(worker, w);
+  }
+  for (auto &i : pool) {
+    i.join();
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::high_resolution_clock::now() - begin)
+                       .count();
+
+  std::cout << sstr("\n", incumbent.solution(), "\n");
+  // Nodes a limit left open still bound the optimum
+  double best = incumbent.value();
+  double bound = pending > 0 ? params.roundBound(globalBound()) : best;
+  spdlog::info(sstr("Best lower bound ", best, ", dual bound ", bound,
+                    ", gap ", relativeGap(best, bound)));
+  for (int w = 0; w < threads; w++) {
+    spdlog::info(sstr("Worker ", w, ": ", stats[w].nodes, " nodes, ",
+                      stats[w].steals, " steals"));
+  }
+  spdlog::info(sstr("Solution found after ", count.load(), " iterations on ",
+                    threads, " threads (", count.load() / seconds,
+                    " nodes/s)"));
+
+  return 0;
+}
+
+namespace {
+// Work of one thread for the current round, and what came of it
+struct RoundSlot {
+  std::shared_ptr<MVOLP::NodeData> node;
+  std::vector<std::shared_ptr<MVOLP::NodeData>> open;
+  long processed = 0;
+  double found = -std::numeric_limits<double>::infinity();
+  std::string solution;
+  // Seconds spent searching, over all rounds
+  double busy = 0;
+};
+} // namespace
+
+/*
+ * Deterministic version of parallelBranchAndBound.  The search runs in rounds:
+ * the t-th best open node goes to thread t, every thread searches its subtree
+ * depth-first for at most budget nodes against the incumbent of the round
+ * start, and the results are merged in thread order once all of them are
+ * done.  Node counts rather than time decide where a round ends, so the tree
+ * only depends on the problem and the parameters.  The price is the time
+ * threads spend waiting for the slowest one at the end of every round, which
+ * is reported against the throughput of the opportunistic search
+ */
+int deterministicBranchAndBound(glp_prob *prob, MVOLP::ParameterObj &params,
+                                int threads, long budget) {
+  params.setObjStep(objectiveStep(prob), glp_get_obj_coef(prob, 0));
+  // The resident set size differs between runs, so stopping on it would make
+  // the tree depend on more than the problem and the parameters
+  if (params.getMemLimit() > 0) {
+    spdlog::info("The memory limit is ignored by the deterministic search");
+    params.setMemLimit(0);
+  }
+  // Whichever method wins the root race leaves its basis to the children
+  if (params.getConcurrentRoot()) {
+    spdlog::info("Concurrent root solves are off in the deterministic search");
+    params.setConcurrentRoot(false);
+  }
+
+  // Open nodes by decreasing bound, then by order of creation
+  std::map<std::pair<double, long>, std::shared_ptr<MVOLP::NodeData>> pool;
+  long seq = 0;
+  std::shared_ptr<MVOLP::NodeData> S1 = std::make_shared<MVOLP::NodeData>(prob);
+  S1->inital = true;
+  pool[{-S1->upperBound, seq++}] = S1;
+
+  double incumbent = -std::numeric_limits<double>::infinity();
+  std::string solution = "";
+  long count = 0;
+  long rounds = 0;
+
+  // Every thread searches with a copy of the parameters taken at the start of
+  // the round, whose pseudocosts are merged back in thread order
+  std::vector<MVOLP::ParameterObj> locals(threads, params);
+  std::vector<RoundSlot> slots(threads);
+
+  std::mutex mutex;
+  std::condition_variable start;
+  std::condition_variable done;
+  long round = 0;
+  int running = 0;
+  bool quit = false;
+
+  int term = getGlpTerm();
+  auto worker = [&](int t) {
+    MVOLP::GlpThreadEnv env(term);
+    MVOLP::SubtreeSearch search(prob, locals[t]);
+    long seen = 0;
+
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        start.wait(lock, [&]() { return quit || round != seen; });
+        if (quit) {
+          break;
+        }
+        seen = round;
+      }
+
+      RoundSlot &slot = slots[t];
+      if (slot.node) {
+        auto begin = std::chrono::high_resolution_clock::now();
+        slot.open = search.search(slot.node, incumbent, budget);
+        slot.processed = search.processed;
+        slot.found = search.found;
+        slot.solution = search.solution;
+        slot.busy += std::chrono::duration<double>(
+                         std::chrono::high_resolution_clock::now() - begin)
+                         .count();
+      }
+
+      std::lock_guard<std::mutex> lock(mutex);
+      if (--running == 0) {
+        done.notify_one();
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back(worker, t);
+  }
+
+  auto begin = std::chrono::high_resolution_clock::now();
+  // Wall time of the search phases, during which the threads are either
+  // searching or waiting at the end of the round
+  double searchTime = 0;
+  while (!pool.empty()) {
+    double cutoff = params.cutoffBound(incumbent);
+    pool.erase(pool.lower_bound({-cutoff, std::numeric_limits<long>::min()}),
+               pool.end());
+    if (pool.empty()) {
+      break;
+    }
+
+    double bound = -pool.begin()->first.first;
+    std::string reason;
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::high_resolution_clock::now() - begin)
+                         .count();
+    if (params.gapReached(incumbent, params.roundBound(bound))) {
+      spdlog::info(sstr("Optimality gap ", relativeGap(incumbent, bound),
+                        " within tolerance"));
+      break;
+    }
+    if (params.limitReached(count, seconds, reason)) {
+      spdlog::info(sstr("Reached the ", reason, ".  Stopping"));
+      break;
+    }
+
+    for (int t = 0; t < threads; t++) {
+      slots[t].node = nullptr;
+      if (!pool.empty()) {
+        slots[t].node = pool.begin()->second;
+        pool.erase(pool.begin());
+      }
+      locals[t] = params;
+    }
+    const MVOLP::ParameterObj base = params;
+
+    auto phase = std::chrono::high_resolution_clock::now();
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      running = threads;
+      round++;
+      start.notify_all();
+      done.wait(lock, [&]() { return running == 0; });
+    }
+    searchTime += std::chrono::duration<double>(
+                      std::chrono::high_resolution_clock::now() - phase)
+                      .count();
+    rounds++;
+
+    for (int t = 0; t < threads; t++) {
+      RoundSlot &slot = slots[t];
+      if (!slot.node) {
+        continue;
+      }
+
+      count += slot.processed;
+      if (slot.found > incumbent) {
+        incumbent = slot.found;
+        solution = slot.solution;
+        spdlog::info(sstr("Round ", rounds, ".  Thread ", t,
+                          " updated best lower bound to ", incumbent));
+      }
+      for (auto &i : slot.open) {
+        pool[{-i->upperBound, seq++}] = i;
+      }
+      slot.open.clear();
+      params.mergeSearchState(locals[t], base);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    quit = true;
+    start.notify_all();
+  }
+  for (auto &i : workers) {
+    i.join();
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::high_resolution_clock::now() - begin)
+                       .count();
+
+  double busy = 0;
+  for (auto &i : slots) {
+    busy += i.busy;
+  }
+  double idle = 0;
+  if (searchTime > 0) {
+    idle = 1 - busy / (searchTime * threads);
+  }
+
+  std::cout << sstr("\n", solution, "\n");
+  // Nodes a limit left open still bound the optimum
+  double bound = pool.empty() ? incumbent
+                              : params.roundBound(-pool.begin()->first.first);
+  spdlog::info(sstr("Best lower bound ", incumbent, ", dual bound ", bound,
+                    ", gap ", relativeGap(incumbent, bound)));
+  params.reportStats();
+  spdlog::info(sstr("Solution found after ", count, " iterations on ",
+                    threads, " threads in ", rounds, " rounds (",
+                    count / seconds, " nodes/s)"));
+  // Neither cost exists in the opportunistic search
+  spdlog::info(sstr("Cost of determinism: threads idle ", idle * 100,
+                    "% of the search time waiting for round ends, ",
+                    seconds - searchTime, " seconds merging rounds"));
+
+  return 0;
+}
+
+namespace {
+// Strategies of the racers after the first, which keeps the configuration it
+// was given.  Roughly from most to least robust
+struct RaceStrategy {
+  MVOLP::param::VarStratType var;
+  MVOLP::param::NodeStratType node;
+  MVOLP::param::CutStratType cut;
+};
+
+const std::vector<RaceStrategy> raceStrategies = {
+    {MVOLP::param::REL, MVOLP::param::BEST, MVOLP::param::NONE},
+    {MVOLP::param::REL, MVOLP::param::BE, MVOLP::param::NONE},
+    {MVOLP::param::PC, MVOLP::param::DFS, MVOLP::param::NONE},
+    {MVOLP::param::SB, MVOLP::param::BEST, MVOLP::param::NONE},
+    {MVOLP::param::REL, MVOLP::param::BE, MVOLP::param::GMI},
+    {MVOLP::param::VFP, MVOLP::param::BEST, MVOLP::param::NONE},
+    {MVOLP::param::PC, MVOLP::param::BE, MVOLP::param::NONE},
+    {MVOLP::param::VGO, MVOLP::param::DFS, MVOLP::param::NONE},
+};
+} // namespace
+
+/*
+ * Portfolio racing.  Every search works on its own copy of the problem, since
+ * restarts and reduced cost fixing change it, but they share one incumbent so
+ * a solution found by any of them prunes all of them.  Strategies repeat once
+ * there are more threads than entries, with a different seed each time
+ */
+int raceBranchAndBound(glp_prob *prob, MVOLP::ParameterObj &params,
+                       int threads) {
+  MVOLP::RaceContext race;
+  std::vector<MVOLP::ParameterObj> configs;
+  for (int r = 0; r < threads; r++) {
+    MVOLP::ParameterObj config = params;
+    if (r > 0) {
+      const RaceStrategy &strategy =
+          raceStrategies[(r - 1) % raceStrategies.size()];
+      config.setVarStrat(strategy.var);
+      config.setNodeStrat(strategy.node);
+      config.setCutStrat(strategy.cut);
+      if (strategy.cut != MVOLP::param::NONE) {
+        config.setCutChance(1.0);
+      }
+      config.setSeed(r);
+      // Only the first search can bind the IPC port
+      config.disableServer();
+    }
+
+    // The open-node budget is split between the searches
+    if (config.getNodeMem() > 0) {
+      std::string path = config.getSpillPath();
+      if (!path.empty()) {
+        path = sstr(path, ".", r);
+      }
+      config.setNodeMem(config.getNodeMem() / threads, path);
+    }
+    configs.push_back(config);
+  }
+
+  int term = getGlpTerm();
+  std::atomic<int> winner = -1;
+  auto begin = std::chrono::high_resolution_clock::now();
+
+  std::vector<std::thread> pool;
+  for (int r = 0; r < threads; r++) {
+    pool.emplace_back([&, r]() {
+      MVOLP::GlpThreadEnv env(term);
+      glp_prob *copy = glp_create_prob();
+      glp_copy_prob(copy, prob, GLP_ON);
+
+      if (branchAndBound(copy, configs[r], &race) == 0) {
+        winner = r;
+      }
+
+      glp_delete_prob(copy);
+    });
+  }
+  for (auto &i : pool) {
+    i.join();
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::high_resolution_clock::now() - begin)
+                       .count();
+
+  std::cout << sstr("\n", race.incumbent.solution(), "\n");
+  if (winner >= 0) {
+    auto strategy = configs[winner].getStrategy();
+    spdlog::info(sstr("Search ", winner.load(), " (-vs ",
+                      (int)std::get<0>(strategy), " -bs ",
+                      (int)std::get<1>(strategy), " -cm ",
+                      (int)std::get<2>(strategy), ") finished first after ",
+                      seconds, " seconds"));
+  } else {
+    spdlog::info(sstr("No search finished within its limits after ", seconds,
+                      " seconds"));
+  }
+
+  return 0;
+}
@@ -0,0 +1,48 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "glpk.h"
+#include "util.h"
+
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <string>
+
+namespace MVOLP {
+// Best integer solution found by any of several concurrent searches
+class SharedIncumbent {
+public:
+  double value() const { return _value.load(); }
+  // Returns true if the candidate improved the incumbent
+  bool update(double value, const std::string &solution);
+  std::string solution() const;
+
+private:
+  std::atomic<double> _value = -std::numeric_limits<double>::infinity();
+  mutable std::mutex _mutex;
+  std::string _solution;
+};
+
+// State shared by the searches of a race
+struct RaceContext {
+  SharedIncumbent incumbent;
+  // Raised by the first search to finish
+  std::atomic<bool> stop = false;
+};
+} // namespace MVOLP
+
+int parallelBranchAndBound(glp_prob *prob, MVOLP::ParameterObj &params,
+                           int threads);
+
+// Parallel search that synchronizes its threads in rounds of at most budget
+// nodes each, so that a given problem and node limit always give the same
+// tree, whatever the timing
+int deterministicBranchAndBound(glp_prob *prob, MVOLP::ParameterObj &params,
+                                int threads, long budget);
+
+// Runs one branchAndBound per thread, each with a different strategy and
+// seed, sharing their incumbents.  The first to finish ends the race
+int raceBranchAndBound(glp_prob *prob, MVOLP::ParameterObj &params,
+                       int threads);
+#endif
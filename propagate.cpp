@@ -0,0 +1,282 @@
+#include "propagate.h"
+
+// std::max
+#include <algorithm>
+// std::ceil, std::floor
+#include <cmath>
+#include <limits>
+
+namespace {
+const double inf = std::numeric_limits<double>::infinity();
+const double feasTol = 1e-6;
+} // namespace
+
+MVOLP::Propagator::Propagator(glp_prob *root)
+    : _rows(glp_get_num_rows(root)), _cols(glp_get_num_cols(root)) {
+  std::vector<int> ind(_cols + 1);
+  std::vector<double> val(_cols + 1);
+
+  _rowStart.push_back(0);
+  _rowInd.push_back(0);
+  _rowVal.push_back(0);
+  _rowLb.assign(_rows + 1, -inf);
+  _rowUb.assign(_rows + 1, inf);
+  std::vector<int> colCount(_cols + 2, 0);
+  for (int i = 1; i <= _rows; i++) {
+    _rowStart.push_back(_rowInd.size());
+    int len = glp_get_mat_row(root, i, ind.data(), val.data());
+    for (int k = 1; k <= len; k++) {
+      _rowInd.push_back(ind[k]);
+      _rowVal.push_back(val[k]);
+      colCount[ind[k] + 1]++;
+    }
+
+    int type = glp_get_row_type(root, i);
+    if (type == GLP_LO || type == GLP_DB || type == GLP_FX) {
+      _rowLb[i] = glp_get_row_lb(root, i);
+    }
+    if (type == GLP_UP || type == GLP_DB || type == GLP_FX) {
+      _rowUb[i] = glp_get_row_ub(root, i);
+    }
+  }
+  _rowStart.push_back(_rowInd.size());
+
+  // Transpose into the column-wise copy
+  _colStart.assign(_cols + 2, 1);
+  for (int j = 1; j <= _cols; j++) {
+    _colStart[j + 1] = _colStart[j] + colCount[j + 1];
+  }
+  _colInd.assign(_rowInd.size(), 0);
+  _colVal.assign(_rowInd.size(), 0);
+  std::vector<int> next(_colStart.begin(), _colStart.end());
+  for (int i = 1; i <= _rows; i++) {
+    for (int k = _rowStart[i]; k < _rowStart[i + 1]; k++) {
+      int pos = next[_rowInd[k]]++;
+      _colInd[pos] = i;
+      _colVal[pos] = _rowVal[k];
+    }
+  }
+
+  _integer.assign(_cols + 1, false);
+  for (int j = 1; j <= _cols; j++) {
+    _integer[j] = glp_get_col_kind(root, j) != GLP_CV;
+  }
+  _queued.assign(_rows + 1, false);
+  _implied.assign(_cols + 1, false);
+
+  reset(root);
+}
+
+void MVOLP::Propagator::reset(glp_prob *root) {
+  _trail.clear();
+  _lb.assign(_cols + 1, -inf);
+  _ub.assign(_cols + 1, inf);
+  _act.assign(_rows + 1, Activity());
+  for (int j = 1; j <= _cols; j++) {
+    getColBnds(root, j, _lb[j], _ub[j]);
+    for (int k = _colStart[j]; k < _colStart[j + 1]; k++) {
+      contribute(_act[_colInd[k]], _colVal[k], _lb[j], _ub[j], 1);
+    }
+  }
+  _rootAct = _act;
+}
+
+void MVOLP::Propagator::contribute(Activity &act, double coef, double lb,
+                                   double ub, int sign) {
+  double low = coef > 0 ? lb : ub;
+  double high = coef > 0 ? ub : lb;
+  if (std::isinf(low)) {
+    act.minInf += sign;
+  } else {
+    act.min += sign * coef * low;
+  }
+  if (std::isinf(high)) {
+    act.maxInf += sign;
+  } else {
+    act.max += sign * coef * high;
+  }
+}
+
+void MVOLP::Propagator::setBounds(int col, double lb, double ub) {
+  for (int k = _colStart[col]; k < _colStart[col + 1]; k++) {
+    Activity &act = _act[_colInd[k]];
+    contribute(act, _colVal[k], _lb[col], _ub[col], -1);
+    contribute(act, _colVal[k], lb, ub, 1);
+  }
+  _lb[col] = lb;
+  _ub[col] = ub;
+}
+
+/*
+ * Integer bounds are rounded.  Continuous bounds must improve noticeably, which
+ * keeps two rows from trading ever smaller tightenings
+ */
+bool MVOLP::Propagator::tighten(int col, double lb, double ub) {
+  if (_integer[col]) {
+    lb = std::ceil(lb - feasTol);
+    ub = std::floor(ub + feasTol);
+  }
+
+  double newLb = _lb[col];
+  double newUb = _ub[col];
+  if (lb > newLb + (_integer[col] ? 0.5 : 1e-3 * std::max(1.0, std::abs(lb)))) {
+    newLb = lb;
+  }
+  if (ub < newUb - (_integer[col] ? 0.5 : 1e-3 * std::max(1.0, std::abs(ub)))) {
+    newUb = ub;
+  }
+  if (newLb == _lb[col] && newUb == _ub[col]) {
+    return true;
+  }
+
+  if (newLb > newUb + feasTol) {
+    return false;
+  }
+  if (newLb > newUb) {
+    newLb = newUb;
+  }
+
+  _trail.push_back({col, _lb[col], _ub[col]});
+  setBounds(col, newLb, newUb);
+  for (int k = _colStart[col]; k < _colStart[col + 1]; k++) {
+    if (!_queued[_colInd[k]]) {
+      _queued[_colInd[k]] = true;
+      _queue.push_back(_colInd[k]);
+    }
+  }
+
+  return true;
+}
+
+/*
+ * For a row L <= a'x <= U and a column j with coefficient a, the rest of the
+ * row is at least minAct - a*lo(j) and at most maxAct - a*hi(j), which bounds
+ * a*x_j from both sides
+ */
+bool MVOLP::Propagator::propagateRow(int row) {
+  const Activity &act = _act[row];
+  // Relative to the side, since the activities are sums of many terms
+  if (act.minInf == 0 &&
+      act.min > _rowUb[row] + feasTol * std::max(1.0, std::abs(_rowUb[row]))) {
+    return false;
+  }
+  if (act.maxInf == 0 &&
+      act.max < _rowLb[row] - feasTol * std::max(1.0, std::abs(_rowLb[row]))) {
+    return false;
+  }
+
+  for (int k = _rowStart[row]; k < _rowStart[row + 1]; k++) {
+    int col = _rowInd[k];
+    double coef = _rowVal[k];
+    double low = coef > 0 ? _lb[col] : _ub[col];
+    double high = coef > 0 ? _ub[col] : _lb[col];
+    double lb = -inf;
+    double ub = inf;
+
+    if (!std::isinf(_rowUb[row])) {
+      double rest = inf;
+      if (std::isinf(low) && act.minInf == 1) {
+        rest = act.min;
+      } else if (!std::isinf(low) && act.minInf == 0) {
+        rest = act.min - coef * low;
+      }
+      if (!std::isinf(rest)) {
+        double bound = (_rowUb[row] - rest) / coef;
+        (coef > 0 ? ub : lb) = bound;
+      }
+    }
+    if (!std::isinf(_rowLb[row])) {
+      double rest = -inf;
+      if (std::isinf(high) && act.maxInf == 1) {
+        rest = act.max;
+      } else if (!std::isinf(high) && act.maxInf == 0) {
+        rest = act.max - coef * high;
+      }
+      if (!std::isinf(rest)) {
+        double bound = (_rowLb[row] - rest) / coef;
+        (coef > 0 ? lb : ub) = bound;
+      }
+    }
+
+    if ((lb != -inf || ub != inf) && !tighten(col, lb, ub)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/*
+ * Restores the root bounds, and the activities of every row they touch from
+ * the copy taken at the root, so rounding error never carries over from one
+ * node to the next
+ */
+void MVOLP::Propagator::rollback() {
+  for (auto i = _trail.rbegin(); i != _trail.rend(); ++i) {
+    _lb[i->col] = i->lb;
+    _ub[i->col] = i->ub;
+    for (int k = _colStart[i->col]; k < _colStart[i->col + 1]; k++) {
+      _act[_colInd[k]] = _rootAct[_colInd[k]];
+    }
+  }
+  _trail.clear();
+
+  for (auto i : _queue) {
+    _queued[i] = false;
+  }
+  _queue.clear();
+}
+
+bool MVOLP::Propagator::propagate(const std::vector<BoundChange> &changes,
+                                  std::vector<BoundChange> &implied) {
+  implied.clear();
+
+  bool feasible = true;
+  for (auto &i : changes) {
+    double lb = std::max(i.lb, _lb[i.col]);
+    double ub = std::min(i.ub, _ub[i.col]);
+    if (lb > ub) {
+      feasible = false;
+      break;
+    }
+    if (lb != _lb[i.col] || ub != _ub[i.col]) {
+      _trail.push_back({i.col, _lb[i.col], _ub[i.col]});
+      setBounds(i.col, lb, ub);
+      for (int k = _colStart[i.col]; k < _colStart[i.col + 1]; k++) {
+        if (!_queued[_colInd[k]]) {
+          _queued[_colInd[k]] = true;
+          _queue.push_back(_colInd[k]);
+        }
+      }
+    }
+  }
+  size_t given = _trail.size();
+
+  // The queue only grows, rows that are re-queued are processed again.  The
+  // work limit bounds chains of small continuous tightenings
+  size_t work = 10 * _rows + 100;
+  for (size_t head = 0; feasible && head < _queue.size() && head < work;
+       head++) {
+    int row = _queue[head];
+    _queued[row] = false;
+    feasible = propagateRow(row);
+  }
+
+  if (feasible) {
+    // Columns changed by propagation, with their final bounds
+    for (size_t k = given; k < _trail.size(); k++) {
+      int col = _trail[k].col;
+      if (!_implied[col]) {
+        _implied[col] = true;
+        implied.push_back({col, _lb[col], _ub[col]});
+      }
+    }
+    for (auto &i : implied) {
+      _implied[i.col] = false;
+    }
+  }
+
+  rollback();
+
+  return feasible;
+}
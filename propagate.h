@@ -0,0 +1,70 @@
+#ifndef PROPAGATE_H
+#define PROPAGATE_H
+
+#include "glpk.h"
+#include "util.h"
+
+#include <vector>
+
+namespace MVOLP {
+/*
+ * Bound propagation over the rows of the root model.  The minimum and maximum
+ * activity of every row is kept for the root bounds and updated incrementally
+ * as the bound changes of a node are applied.  The rows they touched are then
+ * restored from the root activities, so a node costs time proportional to the
+ * rows its changes touch and starts from exact activities.  Cuts are not
+ * included, which only makes the propagation weaker
+ */
+class Propagator {
+public:
+  Propagator(glp_prob *root);
+  // Re-reads the column bounds after the root was tightened globally
+  void reset(glp_prob *root);
+  // Applies the bound changes of a node and propagates them.  Returns false if
+  // the node is infeasible, otherwise sets implied to the bounds it proved
+  bool propagate(const std::vector<BoundChange> &changes,
+                 std::vector<BoundChange> &implied);
+
+private:
+  struct Activity {
+    double min = 0;
+    double max = 0;
+    // Contributions from infinite bounds are counted instead of summed
+    int minInf = 0;
+    int maxInf = 0;
+  };
+  struct TrailEntry {
+    int col;
+    double lb, ub;
+  };
+
+  int _rows;
+  int _cols;
+  // Constraint matrix by row and by column, 1-based like GLPK
+  std::vector<int> _rowStart, _rowInd;
+  std::vector<double> _rowVal;
+  std::vector<int> _colStart, _colInd;
+  std::vector<double> _colVal;
+  std::vector<double> _rowLb, _rowUb;
+  std::vector<bool> _integer;
+
+  std::vector<double> _lb, _ub;
+  std::vector<Activity> _act;
+  // Activities for the root bounds
+  std::vector<Activity> _rootAct;
+  // Previous bounds of every column changed since the last rollback
+  std::vector<TrailEntry> _trail;
+  std::vector<int> _queue;
+  std::vector<bool> _queued;
+  std::vector<bool> _implied;
+
+  void contribute(Activity &act, double coef, double lb, double ub, int sign);
+  void setBounds(int col, double lb, double ub);
+  // Returns false if the new bounds leave col with an empty domain
+  bool tighten(int col, double lb, double ub);
+  bool propagateRow(int row);
+  void rollback();
+};
+} // namespace MVOLP
+
+#endif
@@ -0,0 +1,63 @@
+#include "redcost.h"
+
+// std::floor
+#include <cmath>
+#include <limits>
+
+void MVOLP::ReducedCosts::save(glp_prob *lp) {
+  _objVal = glp_get_obj_val(lp);
+  _cols.clear();
+  _values.clear();
+  _atUpper.clear();
+  _duals.clear();
+
+  for (int j = 1; j <= glp_get_num_cols(lp); j++) {
+    int stat = glp_get_col_stat(lp, j);
+    if (glp_get_col_kind(lp, j) == GLP_CV ||
+        (stat != GLP_NL && stat != GLP_NU)) {
+      continue;
+    }
+
+    double dual = glp_get_col_dual(lp, j);
+    if (std::abs(dual) < 1e-9) {
+      continue;
+    }
+
+    _cols.push_back(j);
+    _atUpper.push_back(stat == GLP_NU);
+    _values.push_back(stat == GLP_NU ? glp_get_col_ub(lp, j)
+                                     : glp_get_col_lb(lp, j));
+    _duals.push_back(dual);
+  }
+}
+
+/*
+ * The solver maximizes, so at an optimal basis a column at its upper bound has
+ * d >= 0 and one at its lower bound has d <= 0
+ */
+std::vector<MVOLP::BoundChange>
+MVOLP::ReducedCosts::fixings(double incumbent) const {
+  std::vector<BoundChange> result;
+  if (incumbent == -std::numeric_limits<double>::infinity()) {
+    return result;
+  }
+
+  const double inf = std::numeric_limits<double>::infinity();
+  double gap = _objVal - incumbent;
+  if (gap < 0) {
+    // Nothing in the tree can beat the incumbent any more
+    return result;
+  }
+  for (size_t k = 0; k < _cols.size(); k++) {
+    double dual = _duals[k];
+    if (_atUpper[k] && dual > 0) {
+      double reach = std::floor(gap / dual + 1e-9);
+      result.push_back({_cols[k], _values[k] - reach, inf});
+    } else if (!_atUpper[k] && dual < 0) {
+      double reach = std::floor(gap / -dual + 1e-9);
+      result.push_back({_cols[k], -inf, _values[k] + reach});
+    }
+  }
+
+  return result;
+}
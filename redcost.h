@@ -0,0 +1,33 @@
+#ifndef REDCOST_H
+#define REDCOST_H
+
+#include "glpk.h"
+#include "util.h"
+
+#include <vector>
+
+namespace MVOLP {
+/*
+ * Reduced costs of the nonbasic integer columns of an optimal LP.  Moving such
+ * a column away from its bound by t lowers the objective by at least |d| * t,
+ * so no solution better than an incumbent L can move it further than
+ * (z - L) / |d|.  Keeping the snapshot lets the root fixings be repeated every
+ * time the incumbent improves.
+ */
+class ReducedCosts {
+public:
+  void save(glp_prob *lp);
+  // Bound changes implied by the incumbent
+  std::vector<BoundChange> fixings(double incumbent) const;
+
+private:
+  double _objVal;
+  std::vector<int> _cols;
+  // Bound each column sits at, and whether it is the upper one
+  std::vector<double> _values;
+  std::vector<bool> _atUpper;
+  std::vector<double> _duals;
+};
+} // namespace MVOLP
+
+#endif
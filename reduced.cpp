@@ -0,0 +1,120 @@
+#include "reduced.h"
+#include "util.h"
+
+MVOLP::ReducedModel::ReducedModel(glp_prob *orig) {
+  _prob = glp_create_prob();
+  glp_copy_prob(_prob, orig, GLP_ON);
+
+  int cols = glp_get_num_cols(orig);
+  _origShift = glp_get_obj_coef(orig, 0);
+  _origCoef.assign(cols + 1, 0);
+  _colMap.assign(cols + 1, 0);
+  _fixedValue.assign(cols + 1, 0);
+  for (int j = 1; j <= cols; j++) {
+    _origCoef[j] = glp_get_obj_coef(orig, j);
+    _colMap[j] = j;
+  }
+}
+
+MVOLP::ReducedModel::~ReducedModel() { glp_delete_prob(_prob); }
+
+/*
+ * Shifts the row bounds by the activity of the fixed columns, then deletes the
+ * columns and any row left empty with 0 inside its bounds
+ */
+int MVOLP::ReducedModel::removeFixed() {
+  int rows = glp_get_num_rows(_prob);
+  int cols = glp_get_num_cols(_prob);
+  std::vector<int> ind(rows + 1);
+  std::vector<double> val(rows + 1);
+
+  std::vector<int> removed;
+  std::vector<double> shift(rows + 1, 0);
+  std::vector<double> value(cols + 1, 0);
+  double objShift = glp_get_obj_coef(_prob, 0);
+  for (int j = 1; j <= cols; j++) {
+    double lb, ub;
+    getColBnds(_prob, j, lb, ub);
+    if (lb != ub) {
+      continue;
+    }
+
+    removed.push_back(j);
+    value[j] = lb;
+    objShift += glp_get_obj_coef(_prob, j) * lb;
+    int len = glp_get_mat_col(_prob, j, ind.data(), val.data());
+    for (int k = 1; k <= len; k++) {
+      shift[ind[k]] += val[k] * lb;
+    }
+  }
+  if (removed.empty()) {
+    return 0;
+  }
+
+  for (int i = 1; i <= rows; i++) {
+    if (shift[i] == 0) {
+      continue;
+    }
+    glp_set_row_bnds(_prob, i, glp_get_row_type(_prob, i),
+                     glp_get_row_lb(_prob, i) - shift[i],
+                     glp_get_row_ub(_prob, i) - shift[i]);
+  }
+  glp_set_obj_coef(_prob, 0, objShift);
+
+  // Renumber the surviving columns the way glp_del_cols does
+  std::vector<int> newIndex(cols + 1, 0);
+  for (int j = 1, next = 1, k = 0; j <= cols; j++) {
+    if (k < (int)removed.size() && removed[k] == j) {
+      k++;
+    } else {
+      newIndex[j] = next++;
+    }
+  }
+  for (size_t o = 1; o < _colMap.size(); o++) {
+    int j = _colMap[o];
+    if (j != 0 && newIndex[j] == 0) {
+      _fixedValue[o] = value[j];
+    }
+    _colMap[o] = j != 0 ? newIndex[j] : 0;
+  }
+
+  std::vector<int> num(removed.size() + 1);
+  std::copy(removed.begin(), removed.end(), num.begin() + 1);
+  glp_del_cols(_prob, removed.size(), num.data());
+
+  std::vector<int> emptyRows(1);
+  for (int i = 1; i <= rows; i++) {
+    if (glp_get_mat_row(_prob, i, NULL, NULL) > 0) {
+      continue;
+    }
+    int type = glp_get_row_type(_prob, i);
+    double lb = glp_get_row_lb(_prob, i);
+    double ub = glp_get_row_ub(_prob, i);
+    bool lbOk = type == GLP_FR || type == GLP_UP || lb <= 1e-9;
+    bool ubOk = type == GLP_FR || type == GLP_LO || ub >= -1e-9;
+    if (lbOk && ubOk) {
+      emptyRows.push_back(i);
+    }
+  }
+  if (emptyRows.size() > 1) {
+    glp_del_rows(_prob, emptyRows.size() - 1, emptyRows.data());
+  }
+
+  return removed.size();
+}
+
+std::string MVOLP::ReducedModel::formatSolution(glp_prob *lp) const {
+  std::string solution = "";
+  for (size_t o = 1; o < _colMap.size(); o++) {
+    double value =
+        _colMap[o] != 0 ? glp_get_col_prim(lp, _colMap[o]) : _fixedValue[o];
+    if (value != 0 && _origCoef[o] != 0) {
+      solution +=
+          sstr(_origCoef[o], "*(x[", o, "] = ", value, ") + ");
+    }
+  }
+
+  solution += sstr(_origShift, " = ", glp_get_obj_val(lp), "\n");
+
+  return solution;
+}
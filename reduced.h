@@ -0,0 +1,43 @@
+#ifndef REDUCED_H
+#define REDUCED_H
+
+#include "glpk.h"
+
+#include <string>
+#include <vector>
+
+namespace MVOLP {
+/*
+ * Working copy of a model from which fixed columns are removed, for restarting
+ * the search on a smaller LP.  A fixed column's contribution moves into the
+ * row bounds and the objective constant, so objective values are unchanged,
+ * and solutions are mapped back to the columns of the original model
+ */
+class ReducedModel {
+public:
+  ReducedModel(glp_prob *orig);
+  ~ReducedModel();
+  ReducedModel(const ReducedModel &other) = delete;
+  ReducedModel &operator=(const ReducedModel &other) = delete;
+
+  // Removes every fixed column of the working model.  Returns how many there
+  // were
+  int removeFixed();
+  glp_prob *prob() { return _prob; }
+  int origCols() const { return _colMap.size() - 1; }
+  // Formats a solution of the working model like formatSolution does for the
+  // original
+  std::string formatSolution(glp_prob *lp) const;
+
+private:
+  glp_prob *_prob;
+  std::vector<double> _origCoef;
+  double _origShift;
+  // Column of the working model for every original column, 0 once it is
+  // fixed at _fixedValue
+  std::vector<int> _colMap;
+  std::vector<double> _fixedValue;
+};
+} // namespace MVOLP
+
+#endif
@@ -0,0 +1,227 @@
+#include "rootsolve.h"
+#include "util.h"
+
+// std::sort
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+// setjmp, longjmp
+#include <csetjmp>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+enum Method { PRIMAL, DUAL, INTERIOR };
+const char *methodNames[] = {"primal simplex", "dual simplex",
+                             "interior point"};
+
+// State of the race, shared by the solving threads
+struct Race {
+  std::mutex mutex;
+  std::condition_variable changed;
+  // Threads that have made their copy of the problem, and that have ended
+  int copied = 0;
+  int ended = 0;
+  int winner = -1;
+  MVOLP::Basis basis;
+  std::atomic<bool> stop = false;
+};
+
+// Per thread way out of a cancelled solve
+struct Cancel {
+  Race *race;
+  std::jmp_buf jump;
+  // Set once the error is raised, which prints through the hook again
+  bool raised = false;
+};
+
+/*
+ * GLPK offers no way to interrupt a solver, but it reports progress through
+ * the terminal hook.  Once the race is won the hook raises an error, and the
+ * error hook jumps out of GLPK, after which only glp_free_env may touch the
+ * thread's environment
+ */
+int pollCancel(void *info, const char *) {
+  Cancel *cancel = static_cast<Cancel *>(info);
+  if (cancel->race->stop && !cancel->raised) {
+    cancel->raised = true;
+    glp_error("cancelled\n");
+  }
+
+  // Nothing is printed, several solvers would interleave
+  return 1;
+}
+
+void jumpOut(void *info) {
+  std::longjmp(static_cast<Cancel *>(info)->jump, 1);
+}
+
+/*
+ * Crossover from the interior point solution: the rows and columns farthest
+ * from their bounds, one per row, are basic and the others are nonbasic at
+ * their nearer bound
+ */
+void crossoverBasis(glp_prob *lp) {
+  int rows = glp_get_num_rows(lp);
+  int cols = glp_get_num_cols(lp);
+  const double inf = std::numeric_limits<double>::infinity();
+
+  // Distance to the nearer bound, and whether that is the lower one, of row
+  // k or column k - rows
+  std::vector<std::pair<double, int>> distance;
+  std::vector<bool> lower(rows + cols + 1);
+  for (int k = 1; k <= rows + cols; k++) {
+    int type;
+    double lb, ub, value;
+    if (k <= rows) {
+      type = glp_get_row_type(lp, k);
+      lb = glp_get_row_lb(lp, k);
+      ub = glp_get_row_ub(lp, k);
+      value = glp_ipt_row_prim(lp, k);
+    } else {
+      type = glp_get_col_type(lp, k - rows);
+      lb = glp_get_col_lb(lp, k - rows);
+      ub = glp_get_col_ub(lp, k - rows);
+      value = glp_ipt_col_prim(lp, k - rows);
+    }
+
+    double down = type == GLP_FR || type == GLP_UP ? inf : value - lb;
+    double up = type == GLP_FR || type == GLP_LO ? inf : ub - value;
+    distance.push_back({std::min(down, up), k});
+    lower[k] = down <= up;
+  }
+  std::sort(distance.begin(), distance.end(),
+            [](const std::pair<double, int> &lhs,
+               const std::pair<double, int> &rhs) {
+              return lhs.first > rhs.first;
+            });
+
+  for (size_t i = 0; i < distance.size(); i++) {
+    int k = distance[i].second;
+    int type = k <= rows ? glp_get_row_type(lp, k)
+                         : glp_get_col_type(lp, k - rows);
+    int stat;
+    if ((int)i < rows) {
+      stat = GLP_BS;
+    } else if (type == GLP_FR) {
+      stat = GLP_NF;
+    } else if (type == GLP_FX) {
+      stat = GLP_NS;
+    } else {
+      stat = lower[k] ? GLP_NL : GLP_NU;
+    }
+
+    if (k <= rows) {
+      glp_set_row_stat(lp, k, stat);
+    } else {
+      glp_set_col_stat(lp, k - rows, stat);
+    }
+  }
+}
+
+// Runs one method on lp.  Any solve in here may be cancelled, so only plain
+// values may live in this frame
+int runMethod(glp_prob *lp, int method, const glp_smcp *parm) {
+  glp_smcp smcp = *parm;
+  // Progress output is how the solver gets interrupted
+  smcp.msg_lev = GLP_MSG_ON;
+  smcp.out_frq = 100;
+  smcp.out_dly = 0;
+
+  if (method == INTERIOR) {
+    glp_iptcp iptcp;
+    glp_init_iptcp(&iptcp);
+    iptcp.msg_lev = GLP_MSG_ON;
+    if (glp_interior(lp, &iptcp) != 0 || glp_ipt_status(lp) != GLP_OPT) {
+      return -1;
+    }
+
+    crossoverBasis(lp);
+    smcp.meth = GLP_PRIMAL;
+  } else {
+    smcp.meth = method == PRIMAL ? GLP_PRIMAL : GLP_DUAL;
+  }
+
+  int ret = glp_simplex(lp, &smcp);
+  if (ret == GLP_EBADB || ret == GLP_ESING || ret == GLP_ECOND) {
+    // The crossover basis was singular
+    glp_adv_basis(lp, 0);
+    ret = glp_simplex(lp, &smcp);
+  }
+
+  return ret;
+}
+
+void racer(glp_prob *root, int method, const glp_smcp *parm, Race &race) {
+  glp_prob *lp = glp_create_prob();
+  glp_copy_prob(lp, root, GLP_OFF);
+  {
+    std::lock_guard<std::mutex> lock(race.mutex);
+    race.copied++;
+  }
+  race.changed.notify_all();
+
+  Cancel cancel;
+  cancel.race = &race;
+  glp_term_out(GLP_ON);
+  glp_term_hook(pollCancel, &cancel);
+  glp_error_hook(jumpOut, &cancel);
+
+  // After a cancel lp is only freed with the environment
+  if (setjmp(cancel.jump) == 0) {
+    int ret = runMethod(lp, method, parm);
+    glp_error_hook(NULL, NULL);
+    glp_term_hook(NULL, NULL);
+
+    {
+      std::lock_guard<std::mutex> lock(race.mutex);
+      if (ret == 0 && race.winner < 0) {
+        race.winner = method;
+        race.basis.save(lp);
+        race.stop = true;
+      }
+    }
+    glp_delete_prob(lp);
+  }
+  glp_free_env();
+
+  {
+    std::lock_guard<std::mutex> lock(race.mutex);
+    race.ended++;
+  }
+  race.changed.notify_all();
+}
+} // namespace
+
+int MVOLP::concurrentSolve(glp_prob *lp, const glp_smcp *parm,
+                           std::string &winner) {
+  Race race;
+  std::vector<std::thread> threads;
+  for (int method : {PRIMAL, DUAL, INTERIOR}) {
+    threads.emplace_back(racer, lp, method, parm, std::ref(race));
+  }
+
+  {
+    // lp is only read until every thread has its own copy
+    std::unique_lock<std::mutex> lock(race.mutex);
+    race.changed.wait(lock, [&]() {
+      return race.copied == 3 && (race.winner >= 0 || race.ended == 3);
+    });
+  }
+  race.stop = true;
+  // The losers stop at their next progress report
+  for (auto &i : threads) {
+    i.join();
+  }
+
+  if (race.winner < 0 || !race.basis.restore(lp)) {
+    return -1;
+  }
+  winner = methodNames[race.winner];
+
+  return glp_simplex(lp, parm);
+}
@@ -0,0 +1,21 @@
+#ifndef ROOTSOLVE_H
+#define ROOTSOLVE_H
+
+#include "glpk.h"
+
+#include <string>
+
+namespace MVOLP {
+/*
+ * Solves lp with the primal simplex, the dual simplex and the interior point
+ * method (followed by a crossover to a basis) at once, each on its own copy
+ * and thread.  The first to finish wins, the others are cancelled, and the
+ * winning basis is installed in lp and re-solved from with parm, so lp ends up
+ * solved exactly as if the simplex had run on it.  Returns the return code of
+ * that last glp_simplex, with the winning method in winner, or -1 if none of
+ * the methods finished and lp was left untouched
+ */
+int concurrentSolve(glp_prob *lp, const glp_smcp *parm, std::string &winner);
+} // namespace MVOLP
+
+#endif
@@ -0,0 +1,36 @@
+#include "subtree.h"
+
+#include <limits>
+
+MVOLP::SubtreeSearch::SubtreeSearch(glp_prob *prob, ParameterObj &params)
+    : found(-std::numeric_limits<double>::infinity()),
+      _processor(prob, params) {}
+
+std::vector<std::shared_ptr<MVOLP::NodeData>>
+MVOLP::SubtreeSearch::search(std::shared_ptr<NodeData> start, double incumbent,
+                             long budget) {
+  processed = 0;
+  found = -std::numeric_limits<double>::infinity();
+  solution = "";
+
+  std::vector<std::shared_ptr<NodeData>> open = {start};
+  while (!open.empty() && processed < budget) {
+    std::shared_ptr<NodeData> node = open.back();
+    open.pop_back();
+    processed++;
+
+    NodeResult result = _processor.process(node, incumbent);
+    if (result.outcome == NodeOutcome::INTEGRAL && result.objVal > incumbent) {
+      incumbent = result.objVal;
+      found = result.objVal;
+      solution = sstr("Solution is: ", formatSolution(_processor.lp()));
+    } else if (result.outcome == NodeOutcome::REEVALUATE) {
+      open.push_back(node);
+    } else if (result.outcome == NodeOutcome::BRANCHED) {
+      open.push_back(result.down);
+      open.push_back(result.up);
+    }
+  }
+
+  return open;
+}
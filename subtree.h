@@ -0,0 +1,39 @@
+#ifndef SUBTREE_H
+#define SUBTREE_H
+
+#include "glpk.h"
+#include "nodeproc.h"
+#include "util.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace MVOLP {
+/*
+ * Depth-first search of the subtree below a node with a budget of nodes, on a
+ * private GLPK workspace.  Used wherever a piece of the tree is searched on
+ * behalf of someone else holding the rest of it.  Must be created and used on
+ * the same thread
+ */
+class SubtreeSearch {
+public:
+  SubtreeSearch(glp_prob *prob, ParameterObj &params);
+
+  // Searches below node until the subtree is exhausted or budget nodes have
+  // been processed, pruning against incumbent.  Returns the nodes left open
+  std::vector<std::shared_ptr<NodeData>>
+  search(std::shared_ptr<NodeData> node, double incumbent, long budget);
+
+  // Results of the last search: nodes processed, and the best solution found
+  // (-inf if none beat the incumbent) formatted like formatSolution
+  long processed = 0;
+  double found;
+  std::string solution;
+
+private:
+  NodeProcessor _processor;
+};
+} // namespace MVOLP
+
+#endif
@@ -1,10 +1,21 @@
 #include "util.h"
+#include "nodequeue.h"
 #include "eigen3/Eigen/Core"
 // debug
 #include "spdlog/spdlog.h"
 #include <iostream>
 // numeric_limits
 #include <limits>
+// std::isfinite
+#include <cmath>
+// std::sort
+#include <algorithm>
+// std::ifstream
+#include <fstream>
+// std::gcd
+#include <numeric>
+// sysconf
+#include <unistd.h>
 // static_assert
 #include <cassert>
 
@@ -22,23 +33,257 @@ double getFract(double x) {
   return fractPart;
 }
 
-MVOLP::NodeData::NodeData(glp_prob *parent) {
+/*
+ * Reads the bounds of a column, reporting missing bounds as infinities rather
+ * than the placeholder values GLPK returns for them
+ */
+void getColBnds(glp_prob *prob, int col, double &lb, double &ub) {
+  int type = glp_get_col_type(prob, col);
+  lb = -std::numeric_limits<double>::infinity();
+  ub = std::numeric_limits<double>::infinity();
+
+  if (type == GLP_LO || type == GLP_DB || type == GLP_FX) {
+    lb = glp_get_col_lb(prob, col);
+  }
+  if (type == GLP_UP || type == GLP_DB || type == GLP_FX) {
+    ub = glp_get_col_ub(prob, col);
+  }
+}
+
+/*
+ * Intersects the current bounds of a column with [lb, ub].  Returns false,
+ * leaving the column unchanged, if the intersection is empty
+ */
+bool tightenColBnds(glp_prob *prob, int col, double lb, double ub) {
+  double curLb, curUb;
+  getColBnds(prob, col, curLb, curUb);
+  lb = std::max(lb, curLb);
+  ub = std::min(ub, curUb);
+
+  if (lb > ub) {
+    return false;
+  }
+
+  bool hasLb = lb != -std::numeric_limits<double>::infinity();
+  bool hasUb = ub != std::numeric_limits<double>::infinity();
+  if (hasLb && hasUb) {
+    glp_set_col_bnds(prob, col, lb == ub ? GLP_FX : GLP_DB, lb, ub);
+  } else if (hasLb) {
+    glp_set_col_bnds(prob, col, GLP_LO, lb, 0);
+  } else if (hasUb) {
+    glp_set_col_bnds(prob, col, GLP_UP, 0, ub);
+  } else {
+    glp_set_col_bnds(prob, col, GLP_FR, 0, 0);
+  }
+
+  return true;
+}
+
+MVOLP::NodeData::NodeData(glp_prob *root) : NodeData(root, id++) {}
+
+MVOLP::NodeData::NodeData(glp_prob *root, int oid) {
   static_assert(std::numeric_limits<double>::is_iec559,
                 "Platform does not support IEE 754 floating-point");
 
-  this->oid = id;
-  id += 1;
+  this->oid = oid;
   this->lowerBound = -std::numeric_limits<double>::infinity();
   this->upperBound = std::numeric_limits<double>::infinity();
-  this->prob = glp_create_prob();
-  glp_copy_prob(this->prob, parent, GLP_ON);
+  this->estimate = this->upperBound;
+  this->depth = 0;
+  this->_root = root;
 
   this->inital = false;
 }
 
+MVOLP::NodeData::NodeData(const NodeData &parent, const BoundChange &change)
+    : NodeData(parent._root) {
+  this->bounds = parent.bounds;
+  this->cuts = parent.cuts;
+  this->depth = parent.depth + 1;
+  this->upperBound = parent.upperBound;
+  this->estimate = parent.estimate;
+  addBound(change);
+}
+
 MVOLP::NodeData::~NodeData() {
   spdlog::debug("Destructor called on objectID: " + std::to_string(this->oid));
-  glp_delete_prob(this->prob);
+}
+
+void MVOLP::NodeData::addBound(const BoundChange &change) {
+  lp.valid = false;
+  for (auto &i : bounds) {
+    if (i.col == change.col) {
+      i.lb = std::max(i.lb, change.lb);
+      i.ub = std::min(i.ub, change.ub);
+      return;
+    }
+  }
+
+  bounds.push_back(change);
+}
+
+void MVOLP::NodeData::addCut(const CutContainer &cut) {
+  lp.valid = false;
+  cuts.push_back(std::make_shared<const CutContainer>(cut));
+}
+
+bool MVOLP::NodeData::buildProb(glp_prob *dest) const {
+  glp_copy_prob(dest, _root, GLP_OFF);
+
+  bool feasible = true;
+  for (auto &i : bounds) {
+    feasible = tightenColBnds(dest, i.col, i.lb, i.ub) && feasible;
+  }
+  for (auto &i : cuts) {
+    addCutRow(dest, *i);
+  }
+
+  return feasible;
+}
+
+void MVOLP::NodeData::saveLP(glp_prob *solved) {
+  lp.valid = true;
+  lp.cutoff = false;
+  lp.status = glp_get_status(solved);
+  if (lp.status == GLP_NOFEAS || lp.status == GLP_INFEAS) {
+    lp.objVal = -std::numeric_limits<double>::infinity();
+  } else if (lp.status == GLP_UNBND) {
+    lp.objVal = std::numeric_limits<double>::infinity();
+  } else {
+    lp.objVal = glp_get_obj_val(solved);
+  }
+
+  saveBasis(solved);
+}
+
+void MVOLP::NodeData::saveBasis(glp_prob *src) { lp.basis.save(src); }
+
+size_t MVOLP::NodeData::memoryUsage() const {
+  return sizeof(NodeData) + bounds.capacity() * sizeof(BoundChange) +
+         cuts.capacity() * sizeof(cuts[0]) + lp.basis.rowStat.capacity() +
+         lp.basis.colStat.capacity();
+}
+
+namespace {
+template <typename T> void writeRaw(std::ostream &out, const T &value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> T readRaw(std::istream &in) {
+  T value;
+  in.read(reinterpret_cast<char *>(&value), sizeof(T));
+
+  return value;
+}
+} // namespace
+
+/*
+ * Layout: oid, depth, bounds, estimate, the LP outcome if it is one that
+ * prunes the node (infeasible or cut off), then the bound changes
+ */
+void MVOLP::NodeData::serialize(std::ostream &out) const {
+  writeRaw(out, oid);
+  writeRaw(out, depth);
+  writeRaw(out, upperBound);
+  writeRaw(out, lowerBound);
+  writeRaw(out, estimate);
+
+  bool keepLP = lp.valid && (lp.cutoff || lp.status != GLP_OPT);
+  writeRaw(out, keepLP);
+  if (keepLP) {
+    writeRaw(out, lp.status);
+    writeRaw(out, lp.cutoff);
+    writeRaw(out, lp.objVal);
+  }
+
+  writeRaw(out, (int)bounds.size());
+  for (auto &i : bounds) {
+    writeRaw(out, i);
+  }
+}
+
+std::shared_ptr<MVOLP::NodeData>
+MVOLP::NodeData::deserialize(std::istream &in, glp_prob *root) {
+  std::shared_ptr<NodeData> node(new NodeData(root, readRaw<int>(in)));
+  node->depth = readRaw<int>(in);
+  node->upperBound = readRaw<double>(in);
+  node->lowerBound = readRaw<double>(in);
+  node->estimate = readRaw<double>(in);
+
+  if (readRaw<bool>(in)) {
+    node->lp.valid = true;
+    node->lp.status = readRaw<int>(in);
+    node->lp.cutoff = readRaw<bool>(in);
+    node->lp.objVal = readRaw<double>(in);
+  }
+
+  int count = readRaw<int>(in);
+  node->bounds.resize(count);
+  for (auto &i : node->bounds) {
+    i = readRaw<BoundChange>(in);
+  }
+
+  return node;
+}
+
+bool MVOLP::NodeData::setBasis(glp_prob *dest) const {
+  return lp.basis.restore(dest);
+}
+
+void MVOLP::Basis::save(glp_prob *src) {
+  int rows = glp_get_num_rows(src);
+  int cols = glp_get_num_cols(src);
+
+  rowStat.resize(rows);
+  for (int i = 1; i <= rows; i++) {
+    rowStat[i - 1] = glp_get_row_stat(src, i);
+  }
+  colStat.resize(cols);
+  for (int j = 1; j <= cols; j++) {
+    colStat[j - 1] = glp_get_col_stat(src, j);
+  }
+}
+
+bool MVOLP::Basis::restore(glp_prob *dest) const {
+  if (rowStat.size() != (size_t)glp_get_num_rows(dest) ||
+      colStat.size() != (size_t)glp_get_num_cols(dest)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < rowStat.size(); i++) {
+    glp_set_row_stat(dest, i + 1, rowStat[i]);
+  }
+  for (size_t j = 0; j < colStat.size(); j++) {
+    glp_set_col_stat(dest, j + 1, colStat[j]);
+  }
+
+  return true;
+}
+
+bool MVOLP::NodeData::loadLP(glp_prob *dest) const {
+  if (!lp.valid || lp.status != GLP_OPT || !setBasis(dest)) {
+    return false;
+  }
+
+  // glp_warm_up factorizes the basis and computes the basic solution
+  if (glp_warm_up(dest) != 0 || glp_get_status(dest) != GLP_OPT) {
+    return false;
+  }
+
+  return true;
+}
+
+void MVOLP::NodeData::setInfeasible() {
+  lp.valid = true;
+  lp.status = GLP_NOFEAS;
+  lp.cutoff = false;
+  lp.objVal = -std::numeric_limits<double>::infinity();
+  upperBound = lp.objVal;
+}
+
+bool MVOLP::NodeData::isInfeasible() const {
+  return lp.valid && !lp.cutoff &&
+         (lp.status == GLP_NOFEAS || lp.status == GLP_INFEAS);
 }
 
 void standard(glp_prob *prob) {
@@ -151,43 +396,80 @@ void standard(glp_prob *prob) {
   }
 }
 
-std::shared_ptr<MVOLP::NodeData> MVOLP::ParameterObj::pickNode(
-    const std::deque<std::shared_ptr<MVOLP::NodeData>> &problems, int &index) {
-  // FIFO node selection
+std::unique_ptr<MVOLP::NodeQueue> MVOLP::ParameterObj::createNodeQueue() {
+  std::unique_ptr<MVOLP::NodeQueue> queue;
   if (_nodeStrat == MVOLP::param::NodeStratType::DFS) {
-    std::string printMe = "";
-    for (auto &i : problems) {
-      printMe += std::to_string(i->upperBound) + " ";
-    }
-    spdlog::debug(
-        sstr("Picked ", problems.front()->upperBound, " from " + printMe));
+    // LIFO node selection
+    queue = std::make_unique<MVOLP::StackNodeQueue>();
+  } else if (_nodeStrat == MVOLP::param::NodeStratType::BE) {
+    // Priority queue node selection (sorted by estimate)
+    queue = std::make_unique<MVOLP::HeapNodeQueue>(MVOLP::betterEstimate);
+  } else {
+    // Priority queue node selection (sorted by upper bound)
+    queue = std::make_unique<MVOLP::HeapNodeQueue>(MVOLP::betterBound);
+  }
 
-    index = 0;
-    return problems.front();
+  if (_nodeMem > 0) {
+    std::string path = _spillPath;
+    if (path.empty()) {
+      // Several queues can be alive at once when searches are raced
+      static std::atomic<int> queues = 0;
+      path = sstr("/tmp/mvolps-", getpid(), "-", queues++, ".spill");
+    }
+    queue->setMemBudget(_nodeMem * 1024 * 1024, path);
   }
 
-  // Priority queue node selection (sorted by upper bound)
-  if (_nodeStrat == MVOLP::param::NodeStratType::BEST) {
-    auto cmp = [](const std::shared_ptr<MVOLP::NodeData> &lhs,
-                  const std::shared_ptr<MVOLP::NodeData> &rhs) -> bool {
-      return lhs->upperBound < rhs->upperBound;
-    };
+  return queue;
+}
 
-    auto i = std::max_element(std::begin(problems), std::end(problems), cmp);
-    index = std::distance(std::begin(problems), i);
-    std::shared_ptr<MVOLP::NodeData> pick = problems.at(index);
+std::shared_ptr<MVOLP::NodeData>
+MVOLP::ParameterObj::pickNode(MVOLP::NodeQueue &problems) {
+  // Plunging: prefer the best child of the node just processed as long as its
+  // bound stays close to the global dual bound
+  if (_nodeStrat == MVOLP::param::NodeStratType::BE) {
+    double best = problems.bestBound();
+    double tol = _plungeTol * std::max(std::abs(best), 1.0);
+    int plunge = -1;
+    for (auto &slot : problems.recent()) {
+      const MVOLP::NodeKey &key = problems.key(slot);
+      if (key.bound >= best - tol &&
+          (plunge < 0 || MVOLP::betterEstimate(key, problems.key(plunge)))) {
+        plunge = slot;
+      }
+    }
 
-    std::string printMe = "";
-    for (auto &j : problems) {
-      printMe += std::to_string(j->upperBound) + " ";
+    if (plunge >= 0) {
+      std::shared_ptr<MVOLP::NodeData> pick = problems.remove(plunge);
+      spdlog::debug(sstr("Plunging into ", pick->oid, " with bound ",
+                         pick->upperBound, " (best ", best, ")"));
+      return pick;
     }
-    spdlog::debug(sstr("Picked ", pick->upperBound, " from " + printMe));
 
-    return pick;
+    if (_boundPickFreq > 0 && ++_globalPicks % _boundPickFreq == 0) {
+      std::shared_ptr<MVOLP::NodeData> pick = problems.popBestBound();
+      spdlog::debug(sstr("Picked ", pick->oid, " with the best bound ",
+                         pick->upperBound));
+      return pick;
+    }
   }
+
+  std::shared_ptr<MVOLP::NodeData> pick = problems.pop();
+  spdlog::debug(sstr("Picked ", pick->upperBound, " from ", problems.size() + 1,
+                     " open nodes"));
+
+  return pick;
 }
 
-int MVOLP::ParameterObj::pickVar(const std::vector<int> &vars) {
+int MVOLP::ParameterObj::pickVar(glp_prob *lp,
+                                 const std::vector<int> &candidates) {
+  _pickProbed = false;
+  std::vector<int> shuffled;
+  if (_seed != 0) {
+    shuffled = candidates;
+    std::shuffle(shuffled.begin(), shuffled.end(), _rng);
+  }
+  const std::vector<int> &vars = _seed != 0 ? shuffled : candidates;
+
   // Terrible default
   if (_varStrat == MVOLP::param::VarStratType::VO) {
     spdlog::debug(sstr("Picked var x[", vars.front(), "] (Front of queue)"));
@@ -197,10 +479,10 @@ int MVOLP::ParameterObj::pickVar(const std::vector<int> &vars) {
   if (_varStrat == MVOLP::param::VarStratType::VFP) {
     double cur;
     double curBest =
-        std::abs(getFract(glp_get_col_prim(_prob, vars.front())) - 0.5);
+        std::abs(getFract(glp_get_col_prim(lp, vars.front())) - 0.5);
     int index = vars.front();
     for (auto &i : vars) {
-      cur = std::abs(getFract(glp_get_col_prim(_prob, i)) - 0.5);
+      cur = std::abs(getFract(glp_get_col_prim(lp, i)) - 0.5);
       if (cur < curBest) {
         curBest = cur;
         index = i;
@@ -217,7 +499,7 @@ int MVOLP::ParameterObj::pickVar(const std::vector<int> &vars) {
     double cur;
     int index;
     for (auto &i : vars) {
-      cur = glp_get_obj_coef(_prob, i);
+      cur = glp_get_obj_coef(lp, i);
       if (cur > bestCoef) {
         bestCoef = cur;
         index = i;
@@ -227,6 +509,397 @@ int MVOLP::ParameterObj::pickVar(const std::vector<int> &vars) {
     spdlog::debug(sstr("Picked var x[", index, "] (Greatest obj. impact)"));
     return index;
   }
+  // Best pseudocost product score
+  if (_varStrat == MVOLP::param::VarStratType::PC) {
+    double downAvg, upAvg;
+    pseudoCostAverages(downAvg, upAvg);
+
+    double bestScore = -1.0;
+    int index = vars.front();
+    for (auto &i : vars) {
+      double cur = pseudoCostScore(i, getFract(glp_get_col_prim(lp, i)),
+                                   downAvg, upAvg);
+      if (cur > bestScore) {
+        bestScore = cur;
+        index = i;
+      }
+    }
+
+    spdlog::debug(sstr("Picked var x[", index, "] (Pseudocost score ",
+                       bestScore, ")"));
+    return index;
+  }
+
+  // Strong branching
+  if (_varStrat == MVOLP::param::VarStratType::SB) {
+    return strongBranch(lp, vars, false);
+  }
+  // Reliability branching
+  if (_varStrat == MVOLP::param::VarStratType::REL) {
+    return strongBranch(lp, vars, true);
+  }
+
+  return vars.front();
+}
+
+/*
+ * Tentatively solves both children of the candidates and picks the one with
+ * the best product of objective degradations.  A candidate with an infeasible
+ * child is fixed to the other side instead, and -1 is returned so the caller
+ * re-evaluates the node with the fixings from takeFixings.  The solution of lp
+ * is restored before returning.
+ *
+ * With reliability set only candidates with fewer than _reliability pseudocost
+ * observations in either direction are probed, in order of their pseudocost
+ * score, and probing stops after _lookahead candidates in a row fail to
+ * improve the best score.  All other candidates are scored by pseudocosts
+ */
+int MVOLP::ParameterObj::strongBranch(glp_prob *lp,
+                                      const std::vector<int> &vars,
+                                      bool reliability) {
+  double downAvg, upAvg;
+  pseudoCostAverages(downAvg, upAvg);
+
+  // Probing overwrites the solution, so read the values up front
+  std::vector<double> values(vars.size());
+  std::vector<double> pcScores(vars.size());
+  std::vector<size_t> order(vars.size());
+  for (size_t k = 0; k < vars.size(); k++) {
+    values[k] = glp_get_col_prim(lp, vars[k]);
+    pcScores[k] =
+        pseudoCostScore(vars[k], getFract(values[k]), downAvg, upAvg);
+    order[k] = k;
+  }
+  if (reliability) {
+    std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+      return pcScores[lhs] > pcScores[rhs];
+    });
+  }
+
+  double parentObj = glp_get_obj_val(lp);
+  Basis start;
+  start.save(lp);
+
+  const double eps = 1e-6;
+  const double inf = std::numeric_limits<double>::infinity();
+  double bestScore = -1.0;
+  int index = vars.front();
+  int sinceImproved = 0;
+  _branchStats.calls++;
+  for (auto &k : order) {
+    int col = vars[k];
+    _branchStats.candidates++;
+
+    double cur = pcScores[k];
+    bool probe = !reliability ||
+                 (!isReliable(col) && sinceImproved < _lookahead);
+    bool probed = false;
+    if (probe) {
+      double down, up;
+      probed = probeVar(lp, col, values[k], parentObj, start, down, up);
+      _branchStats.probed++;
+
+      if (down == inf && up == inf) {
+        // Both children are infeasible, so is the node.  An empty domain
+        // makes its re-evaluation prune it
+        _fixings.push_back({col, ceil(values[k]), floor(values[k])});
+        break;
+      }
+      if (down == inf) {
+        _fixings.push_back({col, ceil(values[k]), inf});
+        continue;
+      }
+      if (up == inf) {
+        _fixings.push_back({col, -inf, floor(values[k])});
+        continue;
+      }
+
+      // A failed probe leaves the candidate with its pseudocost score
+      if (probed) {
+        cur = std::max(down, eps) * std::max(up, eps);
+      }
+    }
+
+    if (cur > bestScore) {
+      bestScore = cur;
+      index = col;
+      // Only a successful probe recorded both sides in the pseudocosts
+      _pickProbed = probed;
+      sinceImproved = 0;
+    } else {
+      sinceImproved++;
+    }
+  }
+
+  start.restore(lp);
+  glp_warm_up(lp);
+
+  if (!_fixings.empty()) {
+    _branchStats.fixings += _fixings.size();
+    spdlog::debug(sstr("Strong branching fixed ", _fixings.size(),
+                       " variables"));
+    return -1;
+  }
+
+  spdlog::debug(sstr("Picked var x[", index, "] (Strong branching score ",
+                     bestScore, ")"));
+  return index;
+}
+
+bool MVOLP::ParameterObj::isReliable(int col) const {
+  if ((size_t)col >= _pseudoCosts.size()) {
+    return _reliability <= 0;
+  }
+
+  const PseudoCost &pc = _pseudoCosts[col];
+  return std::min(pc.downCount, pc.upCount) >= _reliability;
+}
+
+bool MVOLP::ParameterObj::gapReached(double lower, double upper) const {
+  if (lower == -std::numeric_limits<double>::infinity()) {
+    return false;
+  }
+
+  return upper - lower <= _absGap || relativeGap(lower, upper) <= _mipGap;
+}
+
+double MVOLP::ParameterObj::roundBound(double bound) const {
+  if (_objStep == 0 || !std::isfinite(bound)) {
+    return bound;
+  }
+
+  return _objOffset +
+         std::floor((bound - _objOffset) / _objStep + 1e-6) * _objStep;
+}
+
+/*
+ * An improving solution is at least one step better than the incumbent, which
+ * excludes every bound that rounds down to it
+ */
+double MVOLP::ParameterObj::cutoffBound(double incumbent) const {
+  if (_objStep == 0 || !std::isfinite(incumbent)) {
+    return incumbent;
+  }
+
+  return incumbent + _objStep * (1 - 1e-6);
+}
+
+bool MVOLP::ParameterObj::limitReached(long nodes, double seconds,
+                                       std::string &reason) const {
+  if (_nodeLimit > 0 && nodes >= _nodeLimit) {
+    reason = sstr("node limit of ", _nodeLimit);
+    return true;
+  }
+  if (_timeLimit > 0 && seconds >= _timeLimit) {
+    reason = sstr("time limit of ", _timeLimit, "s");
+    return true;
+  }
+  // Reading the resident set size is a system call, so it is sampled
+  if (_memLimit > 0 && nodes % 64 == 0 && residentMemoryMB() >= _memLimit) {
+    reason = sstr("memory limit of ", _memLimit, "MB");
+    return true;
+  }
+
+  return false;
+}
+
+void MVOLP::ParameterObj::reportStats() const {
+  if (_branchStats.calls == 0) {
+    return;
+  }
+
+  spdlog::info(sstr("Strong branching: probed ", _branchStats.probed, " of ",
+                    _branchStats.candidates, " candidates over ",
+                    _branchStats.calls, " branchings, ", _branchStats.fixings,
+                    " variables fixed"));
+}
+
+void MVOLP::ParameterObj::mergeSearchState(const ParameterObj &other,
+                                           const ParameterObj &base) {
+  if (other._pseudoCosts.size() > _pseudoCosts.size()) {
+    _pseudoCosts.resize(other._pseudoCosts.size());
+  }
+  for (size_t j = 0; j < other._pseudoCosts.size(); j++) {
+    PseudoCost before;
+    if (j < base._pseudoCosts.size()) {
+      before = base._pseudoCosts[j];
+    }
+
+    const PseudoCost &after = other._pseudoCosts[j];
+    _pseudoCosts[j].downSum += after.downSum - before.downSum;
+    _pseudoCosts[j].upSum += after.upSum - before.upSum;
+    _pseudoCosts[j].downCount += after.downCount - before.downCount;
+    _pseudoCosts[j].upCount += after.upCount - before.upCount;
+  }
+
+  _branchStats.calls += other._branchStats.calls - base._branchStats.calls;
+  _branchStats.candidates +=
+      other._branchStats.candidates - base._branchStats.candidates;
+  _branchStats.probed += other._branchStats.probed - base._branchStats.probed;
+  _branchStats.fixings +=
+      other._branchStats.fixings - base._branchStats.fixings;
+}
+
+/*
+ * Solves the down and up children of branching on col with an iteration
+ * limited dual simplex started from the basis start.  Reports the degradation
+ * from parentObj of each child, infinity if it is infeasible, or NaN if its
+ * LP failed.  At the iteration limit the dual objective is still a valid bound
+ * on the child.  The probe results also feed the pseudocosts.  Returns false
+ * if either probe failed
+ */
+bool MVOLP::ParameterObj::probeVar(glp_prob *lp, int col, double value,
+                                   double parentObj, const Basis &start,
+                                   double &down, double &up) {
+  glp_smcp parm;
+  glp_init_smcp(&parm);
+  parm.meth = GLP_DUALP;
+  parm.it_lim = _strongIterLimit;
+  parm.msg_lev = GLP_MSG_ERR;
+  parm.tol_bnd = _feasTol;
+
+  const double inf = std::numeric_limits<double>::infinity();
+  int type = glp_get_col_type(lp, col);
+  double lb = glp_get_col_lb(lp, col);
+  double ub = glp_get_col_ub(lp, col);
+
+  auto solve = [&](double newLb, double newUb) -> double {
+    start.restore(lp);
+    tightenColBnds(lp, col, newLb, newUb);
+    int ret = glp_simplex(lp, &parm);
+    int status = glp_get_status(lp);
+    double obj = glp_get_obj_val(lp);
+    glp_set_col_bnds(lp, col, type, lb, ub);
+
+    if (ret != 0 && ret != GLP_EITLIM) {
+      // No information, which is not the same as no degradation
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (status == GLP_NOFEAS) {
+      return inf;
+    }
+
+    return std::max(parentObj - obj, 0.0);
+  };
+
+  down = solve(-inf, floor(value));
+  up = solve(ceil(value), inf);
+
+  updatePseudoCost(col, false, down, value - floor(value));
+  updatePseudoCost(col, true, up, ceil(value) - value);
+
+  return !std::isnan(down) && !std::isnan(up);
+}
+
+std::vector<MVOLP::BoundChange> MVOLP::ParameterObj::takeFixings() {
+  std::vector<MVOLP::BoundChange> fixings;
+  fixings.swap(_fixings);
+
+  return fixings;
+}
+
+/*
+ * The bound minus, for every fractional integer column, the cheaper of the
+ * pseudocost degradations of rounding it down or up
+ */
+double MVOLP::ParameterObj::estimate(glp_prob *lp, double bound) {
+  double downAvg, upAvg;
+  pseudoCostAverages(downAvg, upAvg);
+
+  double est = bound;
+  for (int j = 1; j <= glp_get_num_cols(lp); j++) {
+    if (glp_get_col_kind(lp, j) == GLP_CV) {
+      continue;
+    }
+
+    double fract = getFract(glp_get_col_prim(lp, j));
+    if (fract < 1e-6 || fract > 1 - 1e-6) {
+      continue;
+    }
+
+    double down, up;
+    pseudoCostRates(j, downAvg, upAvg, down, up);
+
+    est -= std::min(down * fract, up * (1 - fract));
+  }
+
+  return est;
+}
+
+void MVOLP::ParameterObj::updatePseudoCost(int col, bool up, double delta,
+                                           double change) {
+  // Infeasible children carry no information about the rate of degradation
+  if (!std::isfinite(delta) || change <= 0) {
+    return;
+  }
+
+  if ((size_t)col >= _pseudoCosts.size()) {
+    _pseudoCosts.resize(col + 1);
+  }
+
+  PseudoCost &pc = _pseudoCosts[col];
+  if (up) {
+    pc.upSum += std::max(delta, 0.0) / change;
+    pc.upCount++;
+  } else {
+    pc.downSum += std::max(delta, 0.0) / change;
+    pc.downCount++;
+  }
+}
+
+/*
+ * Average pseudocost of each direction over the variables that have been
+ * branched on in that direction, or 1 before any observations
+ */
+void MVOLP::ParameterObj::pseudoCostAverages(double &downAvg, double &upAvg) {
+  int downN = 0, upN = 0;
+  downAvg = 0;
+  upAvg = 0;
+  for (auto &i : _pseudoCosts) {
+    if (i.downCount > 0) {
+      downAvg += i.downSum / i.downCount;
+      downN++;
+    }
+    if (i.upCount > 0) {
+      upAvg += i.upSum / i.upCount;
+      upN++;
+    }
+  }
+  downAvg = downN > 0 ? downAvg / downN : 1.0;
+  upAvg = upN > 0 ? upAvg / upN : 1.0;
+}
+
+/*
+ * Per-unit down and up degradation of col, falling back to the given averages
+ * for directions without observations
+ */
+void MVOLP::ParameterObj::pseudoCostRates(int col, double downAvg,
+                                          double upAvg, double &down,
+                                          double &up) const {
+  down = downAvg;
+  up = upAvg;
+  if ((size_t)col < _pseudoCosts.size()) {
+    const PseudoCost &pc = _pseudoCosts[col];
+    if (pc.downCount > 0) {
+      down = pc.downSum / pc.downCount;
+    }
+    if (pc.upCount > 0) {
+      up = pc.upSum / pc.upCount;
+    }
+  }
+}
+
+/*
+ * Product of the estimated down and up degradations of branching on col.
+ * Directions without observations fall back to the given averages
+ */
+double MVOLP::ParameterObj::pseudoCostScore(int col, double fract,
+                                            double downAvg, double upAvg) {
+  double down, up;
+  pseudoCostRates(col, downAvg, upAvg, down, up);
+
+  const double eps = 1e-6;
+  return std::max(down * fract, eps) * std::max(up * (1.0 - fract), eps);
 }
 
 void MVOLP::ParameterObj::pickGenCuts() {
@@ -404,19 +1077,13 @@ glp_prob *initProblem(std::string filename, MVOLP::FileType ft) {
 }
 
 /*
- * Utility function to report on problem progress.
- * Returns pair int and vector<int> the int status is:
- *        -1 for infeasible
- *         0 for normal
- *         1 for integer solution
- * The vector contains the column index of the violated variables
+ * Every column is read once.  A value counts as integral when it is within
+ * intTol of an integer, so LP noise such as 2.9999999999 does not branch
  */
-std::pair<int, std::vector<int>> printInfo(glp_prob *prob,
-                                           bool initial = false) {
+MVOLP::LPInfo printInfo(glp_prob *prob, bool initial, double intTol) {
   int cols = glp_get_num_cols(prob);
   std::string printer("");
-  std::vector<double> coef(cols);
-  std::vector<int> violated;
+  MVOLP::LPInfo info;
 
   // If the initial relaxation has no solution then the IP problem will not
   // have one too
@@ -426,28 +1093,34 @@ std::pair<int, std::vector<int>> printInfo(glp_prob *prob,
       spdlog::info(
           "Initial LP relaxation has no feasible solution.  Terminating");
     }
+    info.status = -1;
 
-    return std::make_pair(-1, violated);
+    return info;
+  }
+
+  std::vector<double> prim(cols + 1);
+  for (int i = 1; i <= cols; i++) {
+    prim[i] = glp_get_col_prim(prob, i);
   }
 
   // Print the non-zero values of the objective coefficients
   std::string printMe = "";
   for (int i = 1; i <= cols; i++) {
-    coef.at(i - 1) = glp_get_col_prim(prob, i);
-    if (coef.at(i - 1) != 0 && glp_get_obj_coef(prob, i) != 0) {
-      printMe += std::to_string(glp_get_obj_coef(prob, i)) + "*(x[" +
-                 std::to_string(i) + "] = " + std::to_string(coef.at(i - 1)) +
-                 ") + ";
-
-      // If our coefficient is fractional and not continuous
-      if (std::trunc(coef.at(i - 1)) != coef.at(i - 1) &&
-          glp_get_col_kind(prob, i) != GLP_CV) {
-        // Store the column index of the violated variable
-        // violated.at(i - 1) = i;
-        violated.push_back(i);
-        printer +=
-            "variable x[" + std::to_string(i) + "] integrality violated ";
-      }
+    double obj = glp_get_obj_coef(prob, i);
+    if (prim[i] != 0 && obj != 0) {
+      printMe += std::to_string(obj) + "*(x[" + std::to_string(i) +
+                 "] = " + std::to_string(prim[i]) + ") + ";
+    }
+
+    if (glp_get_col_kind(prob, i) == GLP_CV) {
+      continue;
+    }
+    double fract = getFract(prim[i]);
+    if (std::min(fract, 1 - fract) > intTol) {
+      // Store the column index of the violated variable
+      info.violated.push_back(i);
+      info.fract.push_back(fract);
+      printer += "variable x[" + std::to_string(i) + "] integrality violated ";
     }
   }
 
@@ -457,19 +1130,144 @@ std::pair<int, std::vector<int>> printInfo(glp_prob *prob,
   spdlog::info(printMe);
 
   // The variables vector is 0
-  if (violated.empty()) {
+  if (info.violated.empty()) {
     if (initial) {
       spdlog::info("OPTIMAL IP SOLUTION FOUND: on initial relaxation");
     } else {
       spdlog::info("IP SOLUTION FOUND");
     }
+    info.status = 1;
 
-    return std::make_pair(1, violated);
+    return info;
   }
 
   spdlog::info(printer);
+  info.status = 0;
+
+  return info;
+}
+
+/*
+ * Builds the LP of a node into the workspace ws and solves it, warm starting
+ * from the node's stored basis when it has one.  The result is saved with the
+ * node.  Hitting the objective cutoff of warm (obj_ll) marks the node as
+ * cut off.  Returns the number of simplex iterations used
+ */
+int solveNode(MVOLP::NodeData &node, glp_prob *ws, const glp_smcp *warm) {
+  if (!node.buildProb(ws)) {
+    node.setInfeasible();
+
+    return 0;
+  }
+
+  // Without a basis the primal simplex starts from scratch, with the same
+  // tolerances
+  glp_smcp cold = *warm;
+  cold.meth = GLP_PRIMAL;
+  cold.obj_ll = -std::numeric_limits<double>::max();
+
+  int before = glp_get_it_cnt(ws);
+  int ret;
+  if (node.setBasis(ws)) {
+    ret = glp_simplex(ws, warm);
+  } else {
+    ret = glp_simplex(ws, &cold);
+  }
+  node.saveLP(ws);
+  if (ret == GLP_EOBJLL) {
+    node.lp.cutoff = true;
+    node.lp.objVal = glp_get_obj_val(ws);
+  }
+  node.upperBound = node.lp.objVal;
+
+  return glp_get_it_cnt(ws) - before;
+}
+
+/*
+ * Formats the non-zero terms of the objective at the current LP solution
+ */
+std::string formatSolution(glp_prob *prob) {
+  std::string solution = "";
+  for (int i = 1; i <= glp_get_num_cols(prob); i++) {
+    if (glp_get_col_prim(prob, i) != 0 && glp_get_obj_coef(prob, i) != 0) {
+      solution += sstr((glp_get_obj_coef(prob, i)), "*(x[", i,
+                       "] = ", (glp_get_col_prim(prob, i)), ") + ");
+    }
+  }
+
+  // Constant (shift) term
+  solution +=
+      sstr(glp_get_obj_coef(prob, 0), " = ", glp_get_obj_val(prob), "\n");
+
+  return solution;
+}
+
+/*
+ * Gap between the incumbent (lower) and the dual bound (upper), relative to
+ * the incumbent
+ */
+double relativeGap(double lower, double upper) {
+  if (lower == -std::numeric_limits<double>::infinity()) {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  return std::max(upper - lower, 0.0) / std::max(std::abs(lower), 1e-10);
+}
+
+/*
+ * The objective only takes multiples of a step when every column with a
+ * non-zero coefficient is integer and the coefficients are all integers after
+ * scaling by a common denominator.  The step is then the GCD of the scaled
+ * coefficients divided by that denominator
+ */
+double objectiveStep(glp_prob *prob) {
+  std::vector<double> coefs;
+  for (int j = 1; j <= glp_get_num_cols(prob); j++) {
+    double coef = glp_get_obj_coef(prob, j);
+    if (coef == 0) {
+      continue;
+    }
+    if (glp_get_col_kind(prob, j) == GLP_CV) {
+      return 0;
+    }
+    coefs.push_back(std::abs(coef));
+  }
+  if (coefs.empty()) {
+    return 0;
+  }
+
+  for (long scale = 1; scale <= 1000; scale++) {
+    long gcd = 0;
+    for (auto i : coefs) {
+      double scaled = i * scale;
+      double error = std::abs(scaled - std::round(scaled));
+      if (scaled > 1e12 || error > 1e-9 * std::max(1.0, scaled)) {
+        gcd = -1;
+        break;
+      }
+      gcd = std::gcd(gcd, (long)std::round(scaled));
+    }
+
+    if (gcd > 0) {
+      return (double)gcd / scale;
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Resident set size of the process, read from /proc/self/statm.  Returns 0 if
+ * it is not available
+ */
+double residentMemoryMB() {
+  std::ifstream statm("/proc/self/statm");
+  long pages, resident;
+  if (!(statm >> pages >> resident)) {
+    return 0;
+  }
 
-  return std::make_pair(0, violated);
+  return resident * (sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0));
 }
 
 /*
@@ -1,9 +1,12 @@
 #ifndef UTIL_H
 #define UTIL_H
+#include "cut.h"
 #include "glpk.h"
 
+#include <atomic>
 #include <memory>
 #include <queue>
+#include <random>
 #include <tuple>
 #include <vector>
 
@@ -14,7 +17,8 @@
 //
 #include <chrono>
 
-static int id = 1;
+// Node IDs are handed out from worker threads in parallel mode
+static std::atomic<int> id = 1;
 static auto startTime = std::chrono::high_resolution_clock::now();
 
 namespace MVOLP {
@@ -27,18 +31,77 @@ enum CondType { FR = 0, LO = 1, UP = 2, DB = 3, FX = 4 };
 enum PruneType { INTG = 0, FEAS = 1, BNDS = 3, NONE };
 
 namespace param {
-enum VarStratType { VO = 0, VFP = 1, VGO = 2 };
-enum NodeStratType { DFS = 0, BEST = 1 };
+enum VarStratType { VO = 0, VFP = 1, VGO = 2, PC = 3, SB = 4, REL = 5 };
+enum NodeStratType { DFS = 0, BEST = 1, BE = 2 };
 enum CutStratType { NONE = 0, GMI = 1 };
 } // namespace param
 
+// Column bounds lb <= x[col] <= ub applied on top of the root model.  An
+// infinite value leaves that side of the column untouched
+struct BoundChange {
+  int col;
+  double lb;
+  double ub;
+};
+
+// Basis statuses (GLP_BS, GLP_NL, ...) of every row and column of an LP
+struct Basis {
+  std::vector<unsigned char> rowStat;
+  std::vector<unsigned char> colStat;
+
+  void save(glp_prob *src);
+  // Returns false if the basis does not match the dimensions of dest
+  bool restore(glp_prob *dest) const;
+};
+
+// Outcome of the last solve of a node LP.  The basis is enough to recover the
+// primal and dual values exactly, so they are not stored separately.  An
+// invalid result may still carry a basis to warm start from
+struct LPResult {
+  bool valid = false;
+  int status = GLP_UNDEF;
+  double objVal = 0;
+  // The dual simplex stopped at the objective cutoff, so objVal is only a
+  // bound showing the node can not beat the incumbent
+  bool cutoff = false;
+  Basis basis;
+};
+
+// Outcome of checking the LP solution of a node for integrality
+struct LPInfo {
+  // -1 if the LP has no solution, 1 if it is integral and 0 otherwise
+  int status;
+  // Integer columns further than the integrality tolerance from an integer,
+  // with the fractional part of each
+  std::vector<int> violated;
+  std::vector<double> fract;
+};
+
+/*
+ * A sub-problem is stored as the list of bound changes (and local cuts) that
+ * separate it from the root model, rather than as a full copy of the LP.  The
+ * node LP is rebuilt on demand with buildProb, so an open node costs O(depth)
+ * memory instead of O(model size).
+ */
 class NodeData {
 public:
-  NodeData(glp_prob *parent);
+  NodeData(glp_prob *root);
+  NodeData(const NodeData &parent, const BoundChange &change);
   ~NodeData();
   double upperBound;
   double lowerBound;
-  glp_prob *prob;
+  // Estimate of the best integer solution in the subtree, from pseudocosts
+  double estimate;
+
+  // Bound changes relative to the root model, at most one entry per column
+  std::vector<BoundChange> bounds;
+  // Cuts are shared between a node and its descendants
+  std::vector<std::shared_ptr<const CutContainer>> cuts;
+  int depth;
+
+  // The node LP is solved once when the node is created.  Changing the delta
+  // invalidates the stored result
+  LPResult lp;
 
   // This field keeps track of whether or not the problem is the initial
   // relaxation
@@ -47,17 +110,71 @@ public:
   // Object ID is used for constructing tree representations
   int oid;
 
+  void addBound(const BoundChange &change);
+  void addCut(const CutContainer &cut);
+  // Rebuilds the node LP into dest.  Returns false if the bound changes leave
+  // a column with an empty domain
+  bool buildProb(glp_prob *dest) const;
+  // Records the solution of the node LP held in solved
+  void saveLP(glp_prob *solved);
+  // Children store their parent's optimal basis until they are solved, which
+  // lets the dual simplex start from it
+  void saveBasis(glp_prob *src);
+  // Copies the stored basis into dest.  Returns false if there is none or it
+  // does not match the dimensions of dest
+  bool setBasis(glp_prob *dest) const;
+  // Restores the stored basis into a problem built by buildProb and recomputes
+  // its solution without pivoting.  Returns false if the LP must be re-solved
+  bool loadLP(glp_prob *dest) const;
+  // Records the node as infeasible without solving its LP
+  void setInfeasible();
+  bool isInfeasible() const;
+  bool isCutoff() const { return lp.valid && lp.cutoff; }
+
+  // Approximate heap footprint of the node, in bytes
+  size_t memoryUsage() const;
+  // Writes the node as a compact record of its bound changes.  Cuts and the
+  // stored basis are dropped, so a reloaded node is a (valid) relaxation of
+  // the original that has to be solved again
+  void serialize(std::ostream &out) const;
+  static std::shared_ptr<NodeData> deserialize(std::istream &in,
+                                               glp_prob *root);
+  glp_prob *root() const { return _root; }
+
 private:
+  glp_prob *_root;
+
+  NodeData(glp_prob *root, int oid);
+
   NodeData(const glp_prob &other);
   NodeData &operator=(const NodeData &other);
 };
 
+class NodeQueue;
+
 // Sub-Problem info
 struct SPInfo {
   int oid;
   PruneType prune;
 };
 
+// Objective degradation per unit change of a variable, summed over the child
+// LPs observed so far
+struct PseudoCost {
+  double downSum = 0;
+  double upSum = 0;
+  int downCount = 0;
+  int upCount = 0;
+};
+
+// Per-run statistics of strong and reliability branching
+struct BranchStats {
+  long calls = 0;
+  long candidates = 0;
+  long probed = 0;
+  long fixings = 0;
+};
+
 class ParameterObj {
 public:
   ParameterObj() = delete;
@@ -69,10 +186,101 @@ public:
     _startServer = false;
   }
 
-  int pickVar(const std::vector<int> &vars);
-  std::shared_ptr<MVOLP::NodeData>
-  pickNode(const std::deque<std::shared_ptr<MVOLP::NodeData>> &problems,
-           int &index);
+  // Picks the branching variable among the fractional columns vars of the
+  // solved LP lp
+  int pickVar(glp_prob *lp, const std::vector<int> &vars);
+  // True if the last pickVar probed the column it picked.  Its pseudocosts
+  // already hold the probe results then
+  bool pickProbed() const { return _pickProbed; }
+  // Records that moving x[col] by change in the given direction degraded the
+  // objective by delta
+  void updatePseudoCost(int col, bool up, double delta, double change);
+  // Bound changes proven by strong branching probes.  pickVar returns -1 when
+  // there are any, and the node has to be re-evaluated with them applied
+  std::vector<MVOLP::BoundChange> takeFixings();
+  void setStrongIterLimit(int limit) { _strongIterLimit = limit; }
+  // Pseudocosts with at least k observations in both directions are trusted
+  // by reliability branching
+  void setReliability(int k) { _reliability = k; }
+  // Reliability branching stops probing after this many candidates in a row
+  // fail to improve the best score
+  void setLookahead(int depth) { _lookahead = depth; }
+  void reportStats() const;
+  // Forgets the pseudocosts, whose column indices a restart invalidates
+  void resetPseudoCosts() { _pseudoCosts.clear(); }
+  // Adds what other has learned since it was copied from base: pseudocost
+  // observations and branching statistics
+  void mergeSearchState(const ParameterObj &other, const ParameterObj &base);
+
+  // The root is restarted on a reduced model once root processing fixes at
+  // least this fraction of the integer columns.  0 disables restarts
+  void setRestartFrac(double frac) { _restartFrac = frac; }
+  double getRestartFrac() const { return _restartFrac; }
+  // Every restart drops the open tree, so there are at most this many
+  void setMaxRestarts(int restarts) { _maxRestarts = restarts; }
+  int getMaxRestarts() const { return _maxRestarts; }
+
+  // The search stops once the incumbent is within these tolerances of the
+  // global dual bound
+  void setMipGap(double gap) { _mipGap = gap; }
+  void setAbsGap(double gap) { _absGap = gap; }
+  bool gapReached(double lower, double upper) const;
+
+  // Objective values are the constant offset plus a multiple of step, so
+  // bounds can be rounded down to the next such value.  A step of 0 turns
+  // the rounding off
+  void setObjStep(double step, double offset) {
+    _objStep = step;
+    _objOffset = offset;
+  }
+  double roundBound(double bound) const;
+  // Nodes whose bound is at most this can not improve on the incumbent
+  double cutoffBound(double incumbent) const;
+
+  // Integer columns within intTol of an integer count as integral.  feasTol
+  // is the primal feasibility tolerance of the simplex (tol_bnd)
+  void setIntTol(double tol) { _intTol = tol; }
+  double getIntTol() const { return _intTol; }
+  void setFeasTol(double tol) { _feasTol = tol; }
+  double getFeasTol() const { return _feasTol; }
+
+  // Resource limits of the search.  A limit of 0 disables it
+  void setTimeLimit(double seconds) { _timeLimit = seconds; }
+  void setNodeLimit(long nodes) { _nodeLimit = nodes; }
+  void setMemLimit(double megabytes) { _memLimit = megabytes; }
+  double getMemLimit() const { return _memLimit; }
+  // Returns true, with the name of the limit in reason, once the search has
+  // to stop
+  bool limitReached(long nodes, double seconds, std::string &reason) const;
+  // Memory budget of the open nodes, beyond which they are spilled to path.
+  // 0 keeps them all in memory
+  void setNodeMem(double megabytes, const std::string &path) {
+    _nodeMem = megabytes;
+    _spillPath = path;
+  }
+  double getNodeMem() const { return _nodeMem; }
+  const std::string &getSpillPath() const { return _spillPath; }
+  // Creates the open-node container matching the node strategy
+  std::unique_ptr<MVOLP::NodeQueue> createNodeQueue();
+  std::shared_ptr<MVOLP::NodeData> pickNode(MVOLP::NodeQueue &problems);
+  // Pseudocost estimate of the best integer solution reachable from the
+  // solved LP lp with objective bound
+  double estimate(glp_prob *lp, double bound);
+  // Best-estimate search keeps diving into a child of the current node while
+  // its bound is within this fraction of the global dual bound
+  void setPlungeTol(double tol) { _plungeTol = tol; }
+  // Every k-th node best-estimate search picks outside a plunge is the one
+  // with the best bound instead, so the dual bound keeps moving.  0 never
+  // picks by bound
+  void setBoundPickFreq(int k) { _boundPickFreq = k; }
+  // Solve the two children of a branching on separate threads in the serial
+  // search
+  void setAsyncChildren(bool async) { _asyncChildren = async; }
+  bool getAsyncChildren() const { return _asyncChildren; }
+  // Race the primal simplex, dual simplex and interior point method on the
+  // root LP
+  void setConcurrentRoot(bool concurrent) { _concurrentRoot = concurrent; }
+  bool getConcurrentRoot() const { return _concurrentRoot; }
   void pickGenCuts();
 
   void setStrategy(const param::VarStratType a, const param::NodeStratType b);
@@ -85,6 +293,14 @@ public:
 
   bool isServerEnabled() { return _startServer; }
   void setServerPort(int port);
+  void disableServer() { _startServer = false; }
+
+  // A non-zero seed shuffles the branching candidates before they are
+  // scored, so searches with different seeds break ties differently
+  void setSeed(unsigned seed) {
+    _seed = seed;
+    _rng.seed(seed);
+  }
   int getServerPort() { return _port; }
 
 private:
@@ -94,8 +310,51 @@ private:
   double _cutChance;
   glp_prob *_prob;
 
+  // Indexed by column, grown on demand
+  std::vector<PseudoCost> _pseudoCosts;
+  void pseudoCostAverages(double &downAvg, double &upAvg);
+  void pseudoCostRates(int col, double downAvg, double upAvg, double &down,
+                       double &up) const;
+  double pseudoCostScore(int col, double fract, double downAvg, double upAvg);
+
+  double _plungeTol = 0.1;
+  int _boundPickFreq = 10;
+  long _globalPicks = 0;
+  bool _asyncChildren = false;
+  bool _concurrentRoot = false;
+  double _restartFrac = 0.2;
+  int _maxRestarts = 3;
+
+  double _mipGap = 0;
+  double _absGap = 0;
+  double _objStep = 0;
+  double _intTol = 1e-6;
+  double _feasTol = 1e-7;
+  double _objOffset = 0;
+
+  double _timeLimit = 0;
+  long _nodeLimit = 200000;
+  double _memLimit = 0;
+  double _nodeMem = 0;
+  std::string _spillPath;
+
+  int _strongIterLimit = 100;
+  int _reliability = 4;
+  int _lookahead = 8;
+  BranchStats _branchStats;
+  std::vector<MVOLP::BoundChange> _fixings;
+  bool _pickProbed = false;
+  int strongBranch(glp_prob *lp, const std::vector<int> &vars,
+                   bool reliability);
+  bool isReliable(int col) const;
+  bool probeVar(glp_prob *lp, int col, double value, double parentObj,
+                const Basis &start, double &down, double &up);
+
   int _port;
   bool _startServer;
+
+  unsigned _seed = 0;
+  std::mt19937 _rng;
 };
 
 // This keeps track of which row, or column we make a change to when
@@ -109,16 +368,48 @@ static std::vector<std::tuple<CondType, double, double>> constraintVector;
 
 double getFract(double x);
 
+void getColBnds(glp_prob *prob, int col, double &lb, double &ub);
+
+bool tightenColBnds(glp_prob *prob, int col, double lb, double ub);
+
 void standard(glp_prob *prob);
 
 glp_prob *initProblem(std::string filename, MVOLP::FileType ft);
 
-std::pair<int, std::vector<int>> printInfo(glp_prob *prob, bool initial);
+MVOLP::LPInfo printInfo(glp_prob *prob, bool initial, double intTol);
 
 double evalObj(std::vector<double> coef);
 
+int solveNode(MVOLP::NodeData &node, glp_prob *ws, const glp_smcp *warm);
+
+std::string formatSolution(glp_prob *prob);
+
+double relativeGap(double lower, double upper);
+
+// Step between the objective values the problem can take, or 0 if they are
+// not restricted to multiples of one
+double objectiveStep(glp_prob *prob);
+
+double residentMemoryMB();
+
 int getGlpTerm();
 
+namespace MVOLP {
+/*
+ * GLPK keeps its environment, including the terminal flag, per thread.  A
+ * thread that uses GLPK creates one of these with the flag of the thread that
+ * started it, before anything GLPK allocates.  Being destroyed last, it frees
+ * the environment after all of them
+ */
+class GlpThreadEnv {
+public:
+  explicit GlpThreadEnv(int term) { glp_term_out(term); }
+  ~GlpThreadEnv() { glp_free_env(); }
+  GlpThreadEnv(const GlpThreadEnv &other) = delete;
+  GlpThreadEnv &operator=(const GlpThreadEnv &other) = delete;
+};
+} // namespace MVOLP
+
 // Template to convert any number of things to std::string
 // Use like: sstr("thing", 1, etc)
 template <typename... Args> std::string sstr(Args &&... args) {